@@ -0,0 +1,26 @@
+#include "auto_execution.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+    constexpr size_t MIN_POSTINGS_PER_THREAD = 16'384;
+
+} // namespace
+
+ExecutionPlan ChooseExecution(const QueryCost& cost, const AutoExecution& policy) {
+    size_t max_threads = policy.max_threads;
+    if (max_threads == 0) {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        max_threads = hardware_threads != 0 ? hardware_threads : 2;
+    }
+    const size_t thread_count = std::min(max_threads, cost.posting_count / MIN_POSTINGS_PER_THREAD);
+    if (thread_count < 2) {
+        return { ExecutionMode::SEQUENTIAL, 1 };
+    }
+    if (cost.term_count >= 2 * thread_count && cost.max_term_postings * thread_count <= 2 * cost.posting_count) {
+        return { ExecutionMode::TERM_PARALLEL, thread_count };
+    }
+    return { ExecutionMode::DOCUMENT_PARALLEL, thread_count };
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+// Политика выполнения "по оценке стоимости" для методов SearchServer, принимающих политику.
+// Запрос оценивается по числу слов и суммарной длине их списков постингов, по оценке выбирается
+// последовательный ход, параллельный по словам или параллельный по диапазонам документов.
+// max_threads - верхняя граница числа потоков, 0 - по числу ядер машины
+struct AutoExecution {
+    size_t max_threads = 0;
+};
+
+inline constexpr AutoExecution auto_execution{};
+
+enum class ExecutionMode {
+    SEQUENTIAL,
+    TERM_PARALLEL,      // слова запроса делятся между потоками
+    DOCUMENT_PARALLEL,  // каждый поток проходит все слова в своём диапазоне id
+};
+
+// оценка стоимости запроса по спискам постингов его плюс-слов
+struct QueryCost {
+    size_t term_count = 0;
+    size_t posting_count = 0;       // сумма длин списков
+    size_t max_term_postings = 0;   // самый длинный список
+};
+
+struct ExecutionPlan {
+    ExecutionMode mode = ExecutionMode::SEQUENTIAL;
+    size_t thread_count = 1;
+};
+
+// Потоков не больше, чем набирается по MIN_POSTINGS_PER_THREAD постингов на поток:
+// на меньшей работе запуск потоков дороже её самой. Слова делятся между потоками, если их хватает
+// на все потоки и ни одно не тянет больше двух долей работы, иначе делятся документы
+ExecutionPlan ChooseExecution(const QueryCost& cost, const AutoExecution& policy);
@@ -0,0 +1,54 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Очередь фиксированной ёмкости для передачи данных между потоками.
+// Push блокируется, пока очередь полна (обратное давление на производителя),
+// Pop - пока она пуста. После Close очередь дочитывается до конца, затем Pop возвращает nullopt.
+template <typename Value>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {
+    }
+
+    // false, если очередь уже закрыта
+    bool Push(Value value) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || data_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        data_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<Value> Pop() {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !data_.empty(); });
+        if (data_.empty()) {
+            return std::nullopt;
+        }
+        Value value = std::move(data_.front());
+        data_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void Close() {
+        std::lock_guard lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::deque<Value> data_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
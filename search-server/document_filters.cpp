@@ -0,0 +1,115 @@
+#include "document_filters.h"
+
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+RatingRange::RatingRange(int min_rating, int max_rating)
+    : min_rating(min_rating), max_rating(max_rating) {
+    if (min_rating > max_rating) {
+        throw std::invalid_argument("Invalid rating range");
+    }
+}
+
+IdModulo::IdModulo(int divisor, int remainder)
+    : divisor(divisor), remainder(remainder) {
+    if (divisor <= 0 || remainder < 0 || remainder >= divisor) {
+        throw std::invalid_argument("Invalid id modulo filter");
+    }
+}
+
+IdIn::IdIn(std::vector<int> document_ids)
+    : document_ids_(std::move(document_ids)) {
+    std::sort(document_ids_.begin(), document_ids_.end());
+    document_ids_.erase(std::unique(document_ids_.begin(), document_ids_.end()), document_ids_.end());
+}
+
+void DocumentColumns::Insert(int document_id, DocumentStatus status, int rating, size_t word_count) {
+    // документы обычно добавляются по возрастанию id - тогда это вставка в конец
+    const size_t slot = ids_.empty() || ids_.back() < document_id ? ids_.size() : FindSlot(document_id);
+    ids_.insert(ids_.begin() + slot, document_id);
+    statuses_.insert(statuses_.begin() + slot, status);
+    ratings_.insert(ratings_.begin() + slot, rating);
+    lengths_.insert(lengths_.begin() + slot, static_cast<uint32_t>(word_count));
+    const double inverse_length = word_count > 0 ? 1.0 / word_count : 0.0;
+    inverse_lengths_.insert(inverse_lengths_.begin() + slot, inverse_length);
+    total_length_ += word_count;
+
+    const size_t id_count = static_cast<size_t>(document_id) + 1;
+    if (dense_ids_ && id_count > inverse_length_by_id_.size()) {
+        if (id_count <= 4 * ids_.size() + 1024) {
+            inverse_length_by_id_.resize(id_count, 0.0);
+        }
+        else {
+            dense_ids_ = false;
+            inverse_length_by_id_ = {};
+        }
+    }
+    if (dense_ids_) {
+        inverse_length_by_id_[document_id] = inverse_length;
+    }
+
+    by_rating_.insert(FindRatingEntry(rating, document_id), RatingEntry{ rating, document_id, status });
+}
+
+void DocumentColumns::Erase(int document_id) {
+    const size_t slot = FindSlot(document_id);
+    by_rating_.erase(FindRatingEntry(ratings_[slot], document_id));
+
+    ids_.erase(ids_.begin() + slot);
+    statuses_.erase(statuses_.begin() + slot);
+    ratings_.erase(ratings_.begin() + slot);
+    total_length_ -= lengths_[slot];
+    if (dense_ids_) {
+        inverse_length_by_id_[document_id] = 0.0;
+    }
+    lengths_.erase(lengths_.begin() + slot);
+    inverse_lengths_.erase(inverse_lengths_.begin() + slot);
+}
+
+void DocumentColumns::Erase(const std::vector<int>& document_ids) {
+    size_t count = 0;
+    size_t next = 0;
+    for (size_t slot = 0; slot < ids_.size(); ++slot) {
+        if (next < document_ids.size() && ids_[slot] == document_ids[next]) {
+            ++next;
+            total_length_ -= lengths_[slot];
+            if (dense_ids_) {
+                inverse_length_by_id_[ids_[slot]] = 0.0;
+            }
+            continue;
+        }
+        ids_[count] = ids_[slot];
+        statuses_[count] = statuses_[slot];
+        ratings_[count] = ratings_[slot];
+        lengths_[count] = lengths_[slot];
+        inverse_lengths_[count] = inverse_lengths_[slot];
+        ++count;
+    }
+    ids_.resize(count);
+    statuses_.resize(count);
+    ratings_.resize(count);
+    lengths_.resize(count);
+    inverse_lengths_.resize(count);
+
+    by_rating_.erase(std::remove_if(by_rating_.begin(), by_rating_.end(),
+        [&document_ids](const RatingEntry& entry) {
+            return std::binary_search(document_ids.begin(), document_ids.end(), entry.document_id);
+        }), by_rating_.end());
+}
+
+std::pair<DocumentColumns::RatingIterator, DocumentColumns::RatingIterator>
+DocumentColumns::FindRatingRange(int min_rating, int max_rating) const {
+    const auto first = std::lower_bound(by_rating_.begin(), by_rating_.end(), min_rating,
+        [](const RatingEntry& entry, int rating) { return entry.rating < rating; });
+    const auto last = std::upper_bound(first, by_rating_.end(), max_rating,
+        [](int rating, const RatingEntry& entry) { return rating < entry.rating; });
+    return { first, last };
+}
+
+DocumentColumns::RatingIterator DocumentColumns::FindRatingEntry(int rating, int document_id) const {
+    return std::lower_bound(by_rating_.begin(), by_rating_.end(), std::make_pair(rating, document_id),
+        [](const RatingEntry& entry, const std::pair<int, int>& key) {
+            return std::tie(entry.rating, entry.document_id) < std::tie(key.first, key.second);
+        });
+}
@@ -0,0 +1,362 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+
+// Словарь фильтров документов для FindTopDocuments / FindDocumentsPage.
+// Каждый фильтр - обычный предикат (id, status, rating), но сервер распознаёт их тип
+// на этапе компиляции и проверяет не через documents_, а по постингам и колоночной таблице:
+// статус - индексом постингов по статусам, фильтры по id - прямо по id постинга,
+// остальное - списком допустимых id, собранным проходом по колонкам таблицы документов.
+// Произвольные лямбды по-прежнему проверяются для каждого документа отдельно.
+// Фильтры объединяются через &&: StatusIs(DocumentStatus::ACTUAL) && IdModulo(2, 0)
+
+struct StatusIs {
+    explicit StatusIs(DocumentStatus status)
+        : status(status) {
+    }
+
+    bool operator()(int, DocumentStatus document_status, int) const {
+        return document_status == status;
+    }
+
+    DocumentStatus status;
+};
+
+// рейтинг в границах [min_rating, max_rating]
+struct RatingRange {
+    RatingRange(int min_rating, int max_rating);
+
+    bool operator()(int, DocumentStatus, int rating) const {
+        return rating >= min_rating && rating <= max_rating;
+    }
+
+    int min_rating;
+    int max_rating;
+};
+
+// id % divisor == remainder, например чётные id - IdModulo(2, 0)
+struct IdModulo {
+    IdModulo(int divisor, int remainder);
+
+    bool MatchesId(int document_id) const {
+        return document_id % divisor == remainder;
+    }
+
+    bool operator()(int document_id, DocumentStatus, int) const {
+        return MatchesId(document_id);
+    }
+
+    int divisor;
+    int remainder;
+};
+
+// id из заданного набора
+class IdIn {
+public:
+    explicit IdIn(std::vector<int> document_ids);
+
+    bool MatchesId(int document_id) const {
+        return std::binary_search(document_ids_.begin(), document_ids_.end(), document_id);
+    }
+
+    bool operator()(int document_id, DocumentStatus, int) const {
+        return MatchesId(document_id);
+    }
+
+    // id по возрастанию, без повторов
+    const std::vector<int>& GetIds() const {
+        return document_ids_;
+    }
+
+private:
+    std::vector<int> document_ids_;
+};
+
+// оба фильтра сразу
+template <typename Lhs, typename Rhs>
+struct AllOf {
+    bool MatchesId(int document_id) const {
+        return lhs.MatchesId(document_id) && rhs.MatchesId(document_id);
+    }
+
+    bool operator()(int document_id, DocumentStatus status, int rating) const {
+        return lhs(document_id, status, rating) && rhs(document_id, status, rating);
+    }
+
+    Lhs lhs;
+    Rhs rhs;
+};
+
+// ------------------------------ распознавание фильтров -------------------------------
+
+template <typename Filter>
+struct IsDocumentFilterType : std::false_type {};
+template <> struct IsDocumentFilterType<StatusIs> : std::true_type {};
+template <> struct IsDocumentFilterType<RatingRange> : std::true_type {};
+template <> struct IsDocumentFilterType<IdModulo> : std::true_type {};
+template <> struct IsDocumentFilterType<IdIn> : std::true_type {};
+template <typename Lhs, typename Rhs>
+struct IsDocumentFilterType<AllOf<Lhs, Rhs>> : std::true_type {};
+
+template <typename Filter>
+inline constexpr bool IsDocumentFilter = IsDocumentFilterType<std::decay_t<Filter>>::value;
+
+// фильтр проверяется только по id документа
+template <typename Filter>
+struct IsIdOnlyFilterType : std::false_type {};
+template <> struct IsIdOnlyFilterType<IdModulo> : std::true_type {};
+template <> struct IsIdOnlyFilterType<IdIn> : std::true_type {};
+template <typename Lhs, typename Rhs>
+struct IsIdOnlyFilterType<AllOf<Lhs, Rhs>>
+    : std::bool_constant<IsIdOnlyFilterType<Lhs>::value && IsIdOnlyFilterType<Rhs>::value> {};
+
+template <typename Filter>
+inline constexpr bool IsIdOnlyFilter = IsIdOnlyFilterType<std::decay_t<Filter>>::value;
+
+template <typename Lhs, typename Rhs,
+    typename = std::enable_if_t<IsDocumentFilter<Lhs> && IsDocumentFilter<Rhs>>>
+AllOf<std::decay_t<Lhs>, std::decay_t<Rhs>> operator&&(Lhs&& lhs, Rhs&& rhs) {
+    return { std::forward<Lhs>(lhs), std::forward<Rhs>(rhs) };
+}
+
+// статус, которым фильтр ограничивает выдачу, если он есть
+template <typename Filter>
+std::optional<DocumentStatus> GetRequiredStatus(const Filter&) {
+    return std::nullopt;
+}
+
+inline std::optional<DocumentStatus> GetRequiredStatus(const StatusIs& filter) {
+    return filter.status;
+}
+
+template <typename Lhs, typename Rhs>
+std::optional<DocumentStatus> GetRequiredStatus(const AllOf<Lhs, Rhs>& filter) {
+    const std::optional<DocumentStatus> status = GetRequiredStatus(filter.lhs);
+    return status ? status : GetRequiredStatus(filter.rhs);
+}
+
+// диапазон рейтинга, которым фильтр ограничивает выдачу, если он есть
+template <typename Filter>
+std::optional<RatingRange> GetRatingRange(const Filter&) {
+    return std::nullopt;
+}
+
+inline std::optional<RatingRange> GetRatingRange(const RatingRange& filter) {
+    return filter;
+}
+
+template <typename Lhs, typename Rhs>
+std::optional<RatingRange> GetRatingRange(const AllOf<Lhs, Rhs>& filter) {
+    const std::optional<RatingRange> range = GetRatingRange(filter.lhs);
+    return range ? range : GetRatingRange(filter.rhs);
+}
+
+// ------------------------------ колоночная таблица -------------------------------
+
+// Атрибуты документов в отдельных массивах по возрастанию id.
+// Фильтр проходит по ним подряд, без обращения к узлам documents_.
+// Дополнительно документы упорядочены по рейтингу - для фильтров по диапазону рейтинга
+// и выдачи лучших по рейтингу. Там же длины документов для моделей ранжирования (scoring.h)
+class DocumentColumns {
+public:
+    struct RatingEntry {
+        int rating = 0;
+        int document_id = 0;
+        DocumentStatus status = DocumentStatus::ACTUAL;
+    };
+
+    using RatingIterator = std::vector<RatingEntry>::const_iterator;
+
+    // word_count - число слов документа без стоп-слов
+    void Insert(int document_id, DocumentStatus status, int rating, size_t word_count);
+
+    void Erase(int document_id);
+
+    // удаление нескольких документов за один проход по таблице,
+    // document_ids - по возрастанию, без повторов, все должны быть в таблице
+    void Erase(const std::vector<int>& document_ids);
+
+    size_t size() const {
+        return ids_.size();
+    }
+
+    // позиция документа в таблице, документ должен существовать
+    size_t FindSlot(int document_id) const {
+        return std::lower_bound(ids_.begin(), ids_.end(), document_id) - ids_.begin();
+    }
+
+    // то же, но поиск продолжается с позиции cursor, документ должен быть не раньше неё.
+    // Шаг растёт вдвое, пока не перескочит документ, поэтому проход по возрастающим id
+    // обходится в среднем в несколько сравнений на документ
+    size_t FindSlotFrom(int document_id, size_t cursor) const {
+        size_t step = 1;
+        size_t bound = cursor;
+        while (bound < ids_.size() && ids_[bound] < document_id) {
+            cursor = bound + 1;
+            bound += step;
+            step *= 2;
+        }
+        return std::lower_bound(ids_.begin() + cursor, ids_.begin() + std::min(bound, ids_.size()), document_id) - ids_.begin();
+    }
+
+    const std::vector<int>& GetIds() const {
+        return ids_;
+    }
+
+    const std::vector<DocumentStatus>& GetStatuses() const {
+        return statuses_;
+    }
+
+    const std::vector<int>& GetRatings() const {
+        return ratings_;
+    }
+
+    // число слов документа без стоп-слов
+    const std::vector<uint32_t>& GetLengths() const {
+        return lengths_;
+    }
+
+    // 1 / число слов документа, 0 для документа без слов
+    const std::vector<double>& GetInverseLengths() const {
+        return inverse_lengths_;
+    }
+
+    // 1 / число слов документа для прохода по постингам (cursor - см. FindSlotFrom).
+    // Пока id документов плотные, значение берётся из массива по id без поиска
+    double GetInverseLength(int document_id, size_t& cursor) const {
+        if (dense_ids_) {
+            return inverse_length_by_id_[document_id];
+        }
+        cursor = FindSlotFrom(document_id, cursor);
+        return inverse_lengths_[cursor];
+    }
+
+    // среднее число слов в документе
+    double GetAverageLength() const {
+        return ids_.empty() ? 0.0 : total_length_ * 1.0 / ids_.size();
+    }
+
+    // документы по возрастанию рейтинга, при равном рейтинге - по возрастанию id
+    const std::vector<RatingEntry>& GetByRating() const {
+        return by_rating_;
+    }
+
+    // документы с рейтингом в [min_rating, max_rating]
+    std::pair<RatingIterator, RatingIterator> FindRatingRange(int min_rating, int max_rating) const;
+
+private:
+    std::vector<int> ids_;
+    std::vector<DocumentStatus> statuses_;
+    std::vector<int> ratings_;
+    std::vector<uint32_t> lengths_;
+    std::vector<double> inverse_lengths_;
+    size_t total_length_ = 0;
+    // те же значения по id документа; ведётся, пока наибольший id не больше чем вчетверо
+    // превышает число документов, при редких id таблица отключается и остаётся поиск
+    std::vector<double> inverse_length_by_id_;
+    bool dense_ids_ = true;
+    std::vector<RatingEntry> by_rating_;
+
+    RatingIterator FindRatingEntry(int rating, int document_id) const;
+};
+
+// Проверка постингов распознанным фильтром на время одного запроса.
+// Выбирается самый дешёвый по оценке способ:
+// - список допустимых id из диапазона рейтинга (если фильтр его задаёт и диапазон узкий);
+// - список допустимых id одним проходом по колонкам;
+// - поиск каждого документа в таблице двоичным поиском (постингов мало).
+// Постинги отсортированы по id, поэтому со списком допустимых id они сверяются слиянием.
+template <typename Filter>
+class FilterCheck {
+public:
+    FilterCheck(const Filter& filter, const DocumentColumns& columns, size_t postings_estimate,
+        std::pmr::memory_resource* resource)
+        : filter_(filter), columns_(columns), allowed_ids_(resource) {
+
+        if constexpr (!IsIdOnlyFilter<Filter>) {
+            const size_t document_count = columns.size();
+            const size_t lookup_cost = postings_estimate * Log2(document_count);
+            size_t best_cost = std::min(lookup_cost, document_count);
+
+            if (const std::optional<RatingRange> range = GetRatingRange(filter)) {
+                const auto [first, last] = columns.FindRatingRange(range->min_rating, range->max_rating);
+                // записи диапазона содержат статус и рейтинг, остаток фильтра проверяется прямо по ним
+                const size_t range_size = static_cast<size_t>(last - first);
+                const size_t range_cost = range_size * Log2(range_size);
+                if (range_cost < best_cost) {
+                    BuildAllowedIds(first, last);
+                    return;
+                }
+            }
+            if (document_count <= lookup_cost) {
+                BuildAllowedIds();
+            }
+        }
+    }
+
+    // cursor - позиция в списке допустимых id, своя на каждый список постингов
+    bool Accepts(int document_id, size_t& cursor) const {
+        if constexpr (IsIdOnlyFilter<Filter>) {
+            return filter_.MatchesId(document_id);
+        }
+        else if (use_allowed_ids_) {
+            cursor = std::lower_bound(allowed_ids_.begin() + cursor, allowed_ids_.end(), document_id) - allowed_ids_.begin();
+            return cursor < allowed_ids_.size() && allowed_ids_[cursor] == document_id;
+        }
+        else {
+            const size_t slot = columns_.FindSlot(document_id);
+            return filter_(document_id, columns_.GetStatuses()[slot], columns_.GetRatings()[slot]);
+        }
+    }
+
+private:
+    const Filter& filter_;
+    const DocumentColumns& columns_;
+    std::pmr::vector<int> allowed_ids_;
+    bool use_allowed_ids_ = false;
+
+    static size_t Log2(size_t value) {
+        size_t result = 1;
+        while (value >>= 1) {
+            ++result;
+        }
+        return result;
+    }
+
+    void BuildAllowedIds(DocumentColumns::RatingIterator first, DocumentColumns::RatingIterator last) {
+        allowed_ids_.reserve(last - first);
+        for (auto it = first; it != last; ++it) {
+            if constexpr (std::is_same_v<Filter, RatingRange>) {
+                allowed_ids_.push_back(it->document_id);
+            }
+            else if (filter_(it->document_id, it->status, it->rating)) {
+                allowed_ids_.push_back(it->document_id);
+            }
+        }
+        std::sort(allowed_ids_.begin(), allowed_ids_.end());
+        use_allowed_ids_ = true;
+    }
+
+    void BuildAllowedIds() {
+        const std::vector<int>& ids = columns_.GetIds();
+        const std::vector<DocumentStatus>& statuses = columns_.GetStatuses();
+        const std::vector<int>& ratings = columns_.GetRatings();
+
+        // запись без ветвлений: id пишется всегда, а позиция сдвигается только при совпадении
+        allowed_ids_.resize(ids.size());
+        size_t count = 0;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            allowed_ids_[count] = ids[i];
+            count += filter_(ids[i], statuses[i], ratings[i]) ? 1 : 0;
+        }
+        allowed_ids_.resize(count);
+        use_allowed_ids_ = true;
+    }
+};
@@ -0,0 +1,72 @@
+#include "document_fingerprint.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    // финальное перемешивание splitmix64
+    uint64_t Mix(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+
+} // namespace
+
+void DocumentFingerprint::AddWord(std::string_view word) {
+    // два хеша с разными множителями, слово читается по 8 байт
+    uint64_t first = 0x9E3779B97F4A7C15ull ^ word.size();
+    uint64_t second = 0xC2B2AE3D27D4EB4Full ^ word.size();
+    size_t pos = 0;
+    for (; pos + sizeof(uint64_t) <= word.size(); pos += sizeof(uint64_t)) {
+        uint64_t chunk = 0;
+        std::memcpy(&chunk, word.data() + pos, sizeof(chunk));
+        first = Mix(first ^ chunk) * 0xFF51AFD7ED558CCDull;
+        second = Mix(second + chunk) * 0xC4CEB9FE1A85EC53ull;
+    }
+    if (pos < word.size()) {
+        uint64_t chunk = 0;
+        std::memcpy(&chunk, word.data() + pos, word.size() - pos);
+        first = Mix(first ^ chunk) * 0xFF51AFD7ED558CCDull;
+        second = Mix(second + chunk) * 0xC4CEB9FE1A85EC53ull;
+    }
+    low += Mix(first);
+    high += Mix(second);
+}
+
+DocumentFingerprint ComputeFingerprint(const std::map<std::string_view, double>& word_freqs) {
+    DocumentFingerprint fingerprint;
+    for (const auto& [word, _] : word_freqs) {
+        fingerprint.AddWord(word);
+    }
+    return fingerprint;
+}
+
+void FingerprintIndex::Add(const DocumentFingerprint& fingerprint, int document_id) {
+    std::vector<int>& ids = documents_[fingerprint];
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), document_id), document_id);
+}
+
+void FingerprintIndex::Remove(const DocumentFingerprint& fingerprint, int document_id) {
+    const auto it = documents_.find(fingerprint);
+    if (it == documents_.end()) {
+        return;
+    }
+    std::vector<int>& ids = it->second;
+    const auto id_it = std::lower_bound(ids.begin(), ids.end(), document_id);
+    if (id_it != ids.end() && *id_it == document_id) {
+        ids.erase(id_it);
+    }
+    if (ids.empty()) {
+        documents_.erase(it);
+    }
+}
+
+const std::vector<int>* FingerprintIndex::Find(const DocumentFingerprint& fingerprint) const {
+    const auto it = documents_.find(fingerprint);
+    return it != documents_.end() ? &it->second : nullptr;
+}
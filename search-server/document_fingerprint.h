@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 128-битный отпечаток множества слов документа.
+// Каждое слово даёт два независимых 64-битных хеша, отпечаток - их суммы по всем словам,
+// поэтому он не зависит от порядка слов и считается за один проход без сортировки и выделения памяти.
+// Случайное совпадение отпечатков разных множеств практически исключено,
+// но при поиске дубликатов совпавшие документы всё равно сверяются по словам.
+struct DocumentFingerprint {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    void AddWord(std::string_view word);
+
+    bool operator==(const DocumentFingerprint& other) const {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator!=(const DocumentFingerprint& other) const {
+        return !(*this == other);
+    }
+};
+
+DocumentFingerprint ComputeFingerprint(const std::map<std::string_view, double>& word_freqs);
+
+struct DocumentFingerprintHasher {
+    size_t operator()(const DocumentFingerprint& fingerprint) const {
+        // обе половины уже перемешаны, достаточно одной
+        return static_cast<size_t>(fingerprint.low);
+    }
+};
+
+// id документов по отпечаткам их множеств слов
+class FingerprintIndex {
+public:
+    void Add(const DocumentFingerprint& fingerprint, int document_id);
+
+    void Remove(const DocumentFingerprint& fingerprint, int document_id);
+
+    // id документов с этим отпечатком по возрастанию, nullptr - таких нет
+    const std::vector<int>* Find(const DocumentFingerprint& fingerprint) const;
+
+private:
+    std::unordered_map<DocumentFingerprint, std::vector<int>, DocumentFingerprintHasher> documents_;
+};
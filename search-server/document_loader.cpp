@@ -0,0 +1,220 @@
+#include "document_loader.h"
+#include "bounded_queue.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+DocumentLoader::DocumentLoader(SearchServer& search_server, LoaderOptions options)
+    : search_server_(search_server), options_(options) {
+    using namespace std::literals::string_literals;
+    // нулевой блок не продвигает чтение, а в очередь нулевой ёмкости ничего не положить
+    if (options_.chunk_size == 0 || options_.queue_capacity == 0) {
+        throw std::invalid_argument("Invalid loader options"s);
+    }
+    if (options_.parser_threads == 0) {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        options_.parser_threads = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+}
+
+void DocumentLoader::LoadFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Can't open corpus file: " + path);
+    }
+    LoadStream(input);
+}
+
+void DocumentLoader::LoadStream(std::istream& input) {
+    BoundedQueue<std::shared_ptr<Chunk>> chunks(options_.queue_capacity);
+    BoundedQueue<Batch> batches(options_.queue_capacity);
+
+    // чтение крупными блоками, хвост неполной строки переносится в следующий блок
+    std::thread reader([this, &input, &chunks] {
+        // начало строки, не поместившейся в прошлый блок, перевода строки в нём нет
+        std::string tail;
+        uint64_t sequence = 0;
+        while (input) {
+            auto chunk = std::make_shared<Chunk>();
+            // хвост переезжает в блок без копирования, память под длинную строку растёт вдвое,
+            // поэтому строка во много блоков длиной читается за линейное время
+            chunk->data = std::move(tail);
+            tail.clear();
+            const size_t tail_size = chunk->data.size();
+            if (chunk->data.capacity() < tail_size + options_.chunk_size) {
+                chunk->data.reserve(std::max(tail_size + options_.chunk_size, 2 * chunk->data.capacity()));
+            }
+            chunk->data.resize(tail_size + options_.chunk_size);
+            input.read(chunk->data.data() + tail_size, options_.chunk_size);
+            const size_t read_count = static_cast<size_t>(input.gcount());
+            progress_.bytes_read += read_count;
+            chunk->data.resize(tail_size + read_count);
+
+            // перевод строки ищется только в дочитанной части
+            size_t last_line_end = chunk->data.size() - 1;
+            if (input) {
+                last_line_end = std::string_view(chunk->data).substr(tail_size).rfind('\n');
+                if (last_line_end == std::string_view::npos) {
+                    // строка длиннее блока - читаем дальше
+                    tail = std::move(chunk->data);
+                    continue;
+                }
+                last_line_end += tail_size;
+            }
+            tail.assign(chunk->data, last_line_end + 1);
+            chunk->data.resize(last_line_end + 1);
+            if (chunk->data.empty()) {
+                continue;
+            }
+            chunk->sequence = sequence++;
+            if (!chunks.Push(std::move(chunk))) {
+                break;
+            }
+        }
+        chunks.Close();
+        });
+
+    std::atomic<size_t> active_parsers = options_.parser_threads;
+    std::vector<std::thread> parsers;
+    for (size_t i = 0; i < options_.parser_threads; ++i) {
+        parsers.emplace_back([this, &chunks, &batches, &active_parsers] {
+            while (auto chunk = chunks.Pop()) {
+                if (!batches.Push(ParseChunk(std::move(*chunk)))) {
+                    break;
+                }
+            }
+            // последний закончивший разборщик закрывает очередь пачек
+            if (--active_parsers == 0) {
+                batches.Close();
+            }
+            });
+    }
+
+    auto stop_pipeline = [&] {
+        chunks.Close();
+        batches.Close();
+        reader.join();
+        for (std::thread& parser : parsers) {
+            parser.join();
+        }
+    };
+
+    // индекс не потокобезопасен на запись - добавление идёт в одном потоке.
+    // Пачки приходят в порядке готовности, обогнавшие ждут своей очереди по номеру блока
+    try {
+        std::map<uint64_t, Batch> pending;
+        uint64_t next_sequence = 0;
+        while (auto batch = batches.Pop()) {
+            pending.emplace(batch->sequence, std::move(*batch));
+            while (!pending.empty() && pending.begin()->first == next_sequence) {
+                AddBatch(pending.begin()->second);
+                pending.erase(pending.begin());
+                ++next_sequence;
+            }
+        }
+    }
+    catch (...) {
+        stop_pipeline();
+        throw;
+    }
+    stop_pipeline();
+}
+
+bool DocumentLoader::ParseLine(std::string_view line, ParsedDocument& document) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    // три первых поля разделены табуляцией, всё после третьей - текст
+    const size_t id_end = line.find('\t');
+    const size_t status_end = id_end == std::string_view::npos ? id_end : line.find('\t', id_end + 1);
+    const size_t ratings_end = status_end == std::string_view::npos ? status_end : line.find('\t', status_end + 1);
+    if (ratings_end == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view id_field = line.substr(0, id_end);
+    const std::string_view status_field = line.substr(id_end + 1, status_end - id_end - 1);
+    const std::string_view ratings_field = line.substr(status_end + 1, ratings_end - status_end - 1);
+
+    auto parse_int = [](std::string_view field, int& value) {
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return error == std::errc() && end == field.data() + field.size();
+    };
+
+    if (!parse_int(id_field, document.document_id)) {
+        return false;
+    }
+
+    if (status_field == "ACTUAL") {
+        document.status = DocumentStatus::ACTUAL;
+    }
+    else if (status_field == "IRRELEVANT") {
+        document.status = DocumentStatus::IRRELEVANT;
+    }
+    else if (status_field == "BANNED") {
+        document.status = DocumentStatus::BANNED;
+    }
+    else if (status_field == "REMOVED") {
+        document.status = DocumentStatus::REMOVED;
+    }
+    else {
+        int status = 0;
+        if (!parse_int(status_field, status) || status < 0 || status > static_cast<int>(DocumentStatus::REMOVED)) {
+            return false;
+        }
+        document.status = static_cast<DocumentStatus>(status);
+    }
+
+    document.ratings.clear();
+    for (std::string_view rating_text : SplitIntoWords(ratings_field)) {
+        int rating = 0;
+        if (!parse_int(rating_text, rating)) {
+            return false;
+        }
+        document.ratings.push_back(rating);
+    }
+
+    document.text = line.substr(ratings_end + 1);
+    return true;
+}
+
+void DocumentLoader::AddBatch(const Batch& batch) {
+    for (const ParsedDocument& document : batch.documents) {
+        try {
+            search_server_.AddDocument(document.document_id, document.text, document.status, document.ratings);
+            ++progress_.documents_added;
+        }
+        catch (const std::invalid_argument&) {
+            ++progress_.documents_rejected;
+        }
+    }
+}
+
+DocumentLoader::Batch DocumentLoader::ParseChunk(std::shared_ptr<Chunk> chunk) {
+    Batch batch;
+    batch.sequence = chunk->sequence;
+    std::string_view data = chunk->data;
+    while (!data.empty()) {
+        const size_t line_end = data.find('\n');
+        const std::string_view line = data.substr(0, line_end);
+        data.remove_prefix(line_end == std::string_view::npos ? data.size() : line_end + 1);
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+
+        ParsedDocument document;
+        if (ParseLine(line, document)) {
+            batch.documents.push_back(std::move(document));
+            ++progress_.documents_parsed;
+        }
+        else {
+            ++progress_.documents_rejected;
+        }
+    }
+    batch.chunk = std::move(chunk);
+    return batch;
+}
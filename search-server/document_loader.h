@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search_server.h"
+
+// Параметры потоковой загрузки, chunk_size и queue_capacity не могут быть нулевыми
+struct LoaderOptions {
+    size_t chunk_size = 4 << 20;      // размер блока чтения, байт
+    size_t parser_threads = 0;        // 0 - по числу ядер
+    size_t queue_capacity = 8;        // ёмкость очередей между стадиями, в блоках
+};
+
+// Счётчики прогресса, можно читать из другого потока во время загрузки
+struct LoadProgress {
+    std::atomic<uint64_t> bytes_read = 0;
+    std::atomic<uint64_t> documents_parsed = 0;
+    std::atomic<uint64_t> documents_added = 0;
+    std::atomic<uint64_t> documents_rejected = 0;   // ошибка разбора строки или AddDocument
+};
+
+// Потоковая загрузка корпуса документов в SearchServer.
+// Формат: один документ на строку
+//     id <TAB> status <TAB> рейтинги через пробел <TAB> текст
+// status - ACTUAL, IRRELEVANT, BANNED, REMOVED или число 0..3.
+// Конвейер: поток чтения читает файл крупными блоками по границам строк,
+// потоки разбора превращают блоки в пачки документов, вызывающий поток
+// добавляет пачки в сервер строго в порядке файла, независимо от того, какой
+// разборщик закончил раньше: повторный id и политика дубликатов дают тот же
+// результат, что и последовательное добавление. Очереди между стадиями ограничены,
+// поэтому быстрое чтение не обгоняет индексацию больше чем на queue_capacity блоков.
+class DocumentLoader {
+public:
+    explicit DocumentLoader(SearchServer& search_server, LoaderOptions options = {});
+
+    void LoadFile(const std::string& path);
+
+    // например std::cin
+    void LoadStream(std::istream& input);
+
+    const LoadProgress& GetProgress() const {
+        return progress_;
+    }
+
+private:
+    // блок входных данных из целых строк
+    struct Chunk {
+        uint64_t sequence = 0;        // номер блока в файле
+        std::string data;
+    };
+
+    struct ParsedDocument {
+        int document_id = 0;
+        DocumentStatus status = DocumentStatus::ACTUAL;
+        std::vector<int> ratings;
+        std::string_view text;        // указывает в блок, которым владеет пачка
+    };
+
+    struct Batch {
+        uint64_t sequence = 0;
+        std::shared_ptr<Chunk> chunk;
+        std::vector<ParsedDocument> documents;
+    };
+
+    SearchServer& search_server_;
+    LoaderOptions options_;
+    LoadProgress progress_;
+
+    // false, если строка не соответствует формату
+    static bool ParseLine(std::string_view line, ParsedDocument& document);
+
+    Batch ParseChunk(std::shared_ptr<Chunk> chunk);
+
+    void AddBatch(const Batch& batch);
+};
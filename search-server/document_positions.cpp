@@ -0,0 +1,55 @@
+#include "document_positions.h"
+
+#include <algorithm>
+
+DocumentPositions::DocumentPositions(std::vector<std::pair<std::string_view, uint32_t>> word_positions) {
+    std::sort(word_positions.begin(), word_positions.end());
+
+    for (size_t i = 0; i < word_positions.size();) {
+        const std::string_view word = word_positions[i].first;
+        Entry entry{ word, static_cast<uint32_t>(data_.size()), 0 };
+        uint32_t previous = 0;
+        for (; i < word_positions.size() && word_positions[i].first == word; ++i) {
+            uint32_t delta = word_positions[i].second - previous;
+            previous = word_positions[i].second;
+            while (delta >= 0x80) {
+                data_.push_back(static_cast<char>((delta & 0x7F) | 0x80));
+                delta >>= 7;
+            }
+            data_.push_back(static_cast<char>(delta));
+            ++entry.count;
+        }
+        entries_.push_back(entry);
+    }
+    entries_.shrink_to_fit();
+    data_.shrink_to_fit();
+}
+
+void DocumentPositions::GetPositions(std::string_view word, std::pmr::vector<uint32_t>& positions) const {
+    positions.clear();
+    const auto it = std::lower_bound(entries_.begin(), entries_.end(), word,
+        [](const Entry& entry, std::string_view value) { return entry.word < value; });
+    if (it == entries_.end() || it->word != word) {
+        return;
+    }
+
+    positions.reserve(it->count);
+    size_t pos = it->offset;
+    uint32_t current = 0;
+    for (uint32_t i = 0; i < it->count; ++i) {
+        uint32_t delta = 0;
+        int shift = 0;
+        uint8_t byte = 0;
+        do {
+            byte = static_cast<uint8_t>(data_[pos++]);
+            delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        current += delta;
+        positions.push_back(current);
+    }
+}
+
+size_t DocumentPositions::GetByteSize() const {
+    return entries_.capacity() * sizeof(Entry) + data_.capacity();
+}
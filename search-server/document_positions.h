@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Позиции слов одного документа для фразовых запросов.
+// Позиция - номер слова в тексте документа, стоп-слова тоже занимают позицию.
+// Для каждого слова хранятся разности соседних позиций в формате varint
+// (7 бит на байт, старший бит - продолжение): обычно один байт на вхождение.
+class DocumentPositions {
+public:
+    DocumentPositions() = default;
+
+    // word_positions - пары (слово, позиция) в любом порядке, слова указывают в текст документа
+    explicit DocumentPositions(std::vector<std::pair<std::string_view, uint32_t>> word_positions);
+
+    // позиции слова по возрастанию, пусто если слова в документе нет
+    void GetPositions(std::string_view word, std::pmr::vector<uint32_t>& positions) const;
+
+    // память, занятая позициями документа
+    size_t GetByteSize() const;
+
+private:
+    struct Entry {
+        std::string_view word;
+        uint32_t offset = 0;   // начало позиций слова в data_
+        uint32_t count = 0;    // число вхождений
+    };
+
+    std::vector<Entry> entries_;   // по возрастанию слова
+    std::string data_;
+};
@@ -0,0 +1,145 @@
+#include "fuzzy_index.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+FuzzyIndex::FuzzyIndex(int max_distance)
+    : max_distance_(max_distance) {
+    if (max_distance < 1 || max_distance > MAX_DISTANCE) {
+        throw std::invalid_argument("Fuzzy search distance must be 1 or 2");
+    }
+}
+
+void FuzzyIndex::AddTerm(std::string_view term) {
+    if (term_ids_.count(std::string(term)) > 0) {
+        return;
+    }
+    uint32_t term_id = 0;
+    if (!free_ids_.empty()) {
+        term_id = free_ids_.back();
+        free_ids_.pop_back();
+        terms_[term_id] = term;
+    }
+    else {
+        term_id = static_cast<uint32_t>(terms_.size());
+        terms_.emplace_back(term);
+    }
+    term_ids_.emplace(term, term_id);
+
+    for (uint64_t key : GetDeleteKeys(term)) {
+        deletes_[key].push_back(term_id);
+    }
+}
+
+void FuzzyIndex::RemoveTerm(std::string_view term) {
+    const auto it = term_ids_.find(std::string(term));
+    if (it == term_ids_.end()) {
+        return;
+    }
+    const uint32_t term_id = it->second;
+    term_ids_.erase(it);
+
+    for (uint64_t key : GetDeleteKeys(term)) {
+        const auto bucket = deletes_.find(key);
+        std::vector<uint32_t>& ids = bucket->second;
+        ids.erase(std::find(ids.begin(), ids.end(), term_id));
+        if (ids.empty()) {
+            deletes_.erase(bucket);
+        }
+    }
+    terms_[term_id].clear();
+    free_ids_.push_back(term_id);
+}
+
+std::vector<std::string_view> FuzzyIndex::FindTerms(std::string_view word, size_t max_count) const {
+    std::vector<uint32_t> candidates;
+    for (uint64_t key : GetDeleteKeys(word)) {
+        const auto bucket = deletes_.find(key);
+        if (bucket != deletes_.end()) {
+            candidates.insert(candidates.end(), bucket->second.begin(), bucket->second.end());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<std::string_view> result;
+    int best_distance = max_distance_;
+    for (uint32_t term_id : candidates) {
+        const std::string_view term = terms_[term_id];
+        const int distance = ComputeDistance(word, term, best_distance);
+        if (distance > best_distance) {
+            continue;
+        }
+        if (distance < best_distance) {
+            best_distance = distance;
+            result.clear();
+        }
+        result.push_back(term);
+    }
+
+    // при одинаковом расстоянии - по алфавиту, чтобы выдача не зависела от номеров слов
+    std::sort(result.begin(), result.end());
+    if (result.size() > max_count) {
+        result.resize(max_count);
+    }
+    return result;
+}
+
+std::vector<uint64_t> FuzzyIndex::GetDeleteKeys(std::string_view word) const {
+    const std::string_view prefix = word.substr(0, std::min(word.size(), PREFIX_LENGTH));
+    const size_t length = prefix.size();
+
+    // вариант не длиннее PREFIX_LENGTH байт целиком укладывается в ключ: байты слова и длина в старшем байте
+    const auto make_key = [prefix, length](size_t skip_first, size_t skip_second) {
+        uint64_t key = 0;
+        size_t size = 0;
+        for (size_t i = 0; i < length; ++i) {
+            if (i != skip_first && i != skip_second) {
+                key |= static_cast<uint64_t>(static_cast<uint8_t>(prefix[i])) << (8 * size++);
+            }
+        }
+        return key | (static_cast<uint64_t>(size) << 56);
+    };
+
+    std::vector<uint64_t> keys;
+    keys.push_back(make_key(length, length));
+    for (size_t i = 0; i < length; ++i) {
+        keys.push_back(make_key(i, length));
+        if (max_distance_ > 1) {
+            for (size_t j = i + 1; j < length; ++j) {
+                keys.push_back(make_key(i, j));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+int FuzzyIndex::ComputeDistance(std::string_view lhs, std::string_view rhs, int limit) {
+    const int length_difference = static_cast<int>(lhs.size()) - static_cast<int>(rhs.size());
+    if (length_difference > limit || -length_difference > limit) {
+        return limit + 1;
+    }
+
+    // две строки таблицы динамики, строка прерывается, если все значения в ней больше limit
+    std::vector<int> previous(rhs.size() + 1);
+    std::vector<int> current(rhs.size() + 1);
+    for (size_t j = 0; j <= rhs.size(); ++j) {
+        previous[j] = static_cast<int>(j);
+    }
+    for (size_t i = 1; i <= lhs.size(); ++i) {
+        current[0] = static_cast<int>(i);
+        int row_min = current[0];
+        for (size_t j = 1; j <= rhs.size(); ++j) {
+            const int substitution = previous[j - 1] + (lhs[i - 1] == rhs[j - 1] ? 0 : 1);
+            current[j] = std::min({ previous[j] + 1, current[j - 1] + 1, substitution });
+            row_min = std::min(row_min, current[j]);
+        }
+        if (row_min > limit) {
+            return limit + 1;
+        }
+        std::swap(previous, current);
+    }
+    return std::min(previous[rhs.size()], limit + 1);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Поиск слов словаря с опечатками через индекс удалений (SymSpell).
+// Для каждого слова заранее записаны все варианты его начала (PREFIX_LENGTH символов)
+// с удалением до max_distance символов. У слов на расстоянии Левенштейна не больше max_distance
+// найдётся общий вариант, поэтому для запроса достаточно построить его варианты
+// и проверить точным расстоянием только слова из тех же корзин, без перебора словаря.
+// Вариант начала слова не длиннее 7 байт и хранится как число, без строк и хеширования.
+class FuzzyIndex {
+public:
+    static constexpr int MAX_DISTANCE = 2;
+    static constexpr size_t PREFIX_LENGTH = 7;
+
+    explicit FuzzyIndex(int max_distance);
+
+    int GetMaxDistance() const {
+        return max_distance_;
+    }
+
+    size_t GetTermCount() const {
+        return term_ids_.size();
+    }
+
+    void AddTerm(std::string_view term);
+
+    void RemoveTerm(std::string_view term);
+
+    // ближайшие к word слова словаря: все слова с наименьшим найденным расстоянием,
+    // не дальше max_distance и не больше max_count штук
+    std::vector<std::string_view> FindTerms(std::string_view word, size_t max_count) const;
+
+private:
+    int max_distance_;
+    std::vector<std::string> terms_;                      // слово по номеру, пустое - номер свободен
+    std::vector<uint32_t> free_ids_;
+    std::unordered_map<std::string, uint32_t> term_ids_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> deletes_;   // вариант -> номера слов
+
+    // варианты начала слова с удалением до max_distance_ символов, без повторов,
+    // каждый вариант упакован в 64-битный ключ
+    std::vector<uint64_t> GetDeleteKeys(std::string_view word) const;
+
+    // расстояние Левенштейна, если оно не больше limit, иначе limit + 1
+    static int ComputeDistance(std::string_view lhs, std::string_view rhs, int limit);
+};
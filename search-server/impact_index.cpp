@@ -0,0 +1,34 @@
+#include "impact_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+ImpactIndex::ImpactIndex(double max_score)
+    : step_(max_score > 0.0 ? max_score / MAX_IMPACT : 1.0) {
+}
+
+uint16_t ImpactIndex::Quantize(double score) const {
+    const long impact = std::lround(score / step_);
+    return static_cast<uint16_t>(std::clamp<long>(impact, 1, MAX_IMPACT));
+}
+
+const ImpactIndex::Postings* ImpactIndex::FindPostings(std::string_view word, size_t status_index) const {
+    const auto it = postings_.find(word);
+    return it != postings_.end() ? &it->second[status_index] : nullptr;
+}
+
+uint32_t ImpactIndex::FindImpact(const Postings& postings, uint32_t slot) {
+    const auto it = std::lower_bound(postings.slots.begin(), postings.slots.end(), slot);
+    return it != postings.slots.end() && *it == slot ? postings.impacts[it - postings.slots.begin()] : 0;
+}
+
+size_t ImpactIndex::GetByteSize() const {
+    size_t size = 0;
+    for (const auto& [_, status_postings] : postings_) {
+        for (const Postings& postings : status_postings) {
+            size += postings.slots.capacity() * sizeof(uint32_t) + postings.impacts.capacity() * sizeof(uint16_t)
+                + postings.order.capacity() * sizeof(uint32_t);
+        }
+    }
+    return size;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <vector>
+
+// Квантованные вклады постингов в релевантность для выдачи по статусу.
+// Вклад постинга (TF x IDF или BM25) считается заранее и хранится как 16-битное число
+// в единицах шага квантования, общего для всех слов, поэтому вклады разных слов складываются
+// целыми числами. Документ хранится позицией в колонках DocumentColumns, а не id:
+// суммы копятся в плоском массиве по этой позиции.
+// Каждый вклад отличается от точного не больше чем на шаг, ненулевой вклад не меньше 1 -
+// совпадение документа с запросом не теряется.
+// Индекс - снимок базы на момент построения, при любом изменении базы он сбрасывается.
+class ImpactIndex {
+public:
+    static constexpr size_t STATUS_COUNT = 4;
+    static constexpr uint32_t MAX_IMPACT = UINT16_MAX;
+    // порядок по убыванию вклада хранится только для длинных списков,
+    // короткий дешевле упорядочить во время запроса
+    static constexpr size_t MIN_ORDERED_POSTINGS = 128;
+
+    // документы одного слова одного статуса, массивы одной длины
+    struct Postings {
+        std::vector<uint32_t> slots;     // позиции документов в колонках по возрастанию
+        std::vector<uint16_t> impacts;
+        std::vector<uint32_t> order;     // номера постингов по убыванию вклада, пусто для коротких списков
+    };
+
+    // max_score - наибольший вклад постинга, ему соответствует MAX_IMPACT
+    explicit ImpactIndex(double max_score);
+
+    uint16_t Quantize(double score) const;
+
+    // цена одной единицы вклада
+    double GetStep() const {
+        return step_;
+    }
+
+    Postings& GetPostings(std::string_view word, size_t status_index) {
+        return postings_[word][status_index];
+    }
+
+    // nullptr, если слова в индексе нет
+    const Postings* FindPostings(std::string_view word, size_t status_index) const;
+
+    // вклад документа в позиции slot, 0 - документа в постингах нет
+    static uint32_t FindImpact(const Postings& postings, uint32_t slot);
+
+    // номера постингов по убыванию вклада, при равном вкладе - по возрастанию позиции
+    template <typename Container>
+    static void FillOrder(const Postings& postings, Container& order) {
+        order.resize(postings.impacts.size());
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&postings](uint32_t lhs, uint32_t rhs) { return postings.impacts[lhs] > postings.impacts[rhs]; });
+    }
+
+    // заполняет order длинного списка по уже записанным вкладам
+    static void BuildOrder(Postings& postings) {
+        if (postings.impacts.size() >= MIN_ORDERED_POSTINGS) {
+            FillOrder(postings, postings.order);
+        }
+    }
+
+    // прибавляет вклады постингов к суммам по позициям документов
+    static void Accumulate(const Postings& postings, uint32_t* sums) {
+        const uint32_t* slots = postings.slots.data();
+        const uint16_t* impacts = postings.impacts.data();
+        for (size_t i = 0, size = postings.slots.size(); i < size; ++i) {
+            sums[slots[i]] += impacts[i];
+        }
+    }
+
+    // память, занятая постингами
+    size_t GetByteSize() const;
+
+private:
+    double step_;
+    std::map<std::string_view, std::array<Postings, STATUS_COUNT>> postings_;
+};
@@ -0,0 +1,22 @@
+#include "index_format.h"
+
+#include <cstring>
+
+uint64_t ComputeIndexChecksum(std::string_view data) {
+    const uint64_t prime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+
+    // основной проход по 8 байт, хвост побайтово
+    size_t pos = 0;
+    for (; pos + sizeof(uint64_t) <= data.size(); pos += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + pos, sizeof(word));
+        hash ^= word;
+        hash *= prime;
+    }
+    for (; pos < data.size(); ++pos) {
+        hash ^= static_cast<unsigned char>(data[pos]);
+        hash *= prime;
+    }
+    return hash;
+}
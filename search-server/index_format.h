@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Бинарный формат снимка индекса SearchServer.
+// Файл: заголовок, таблица секций, затем секции, каждая выровнена на 8 байт.
+// Все записи - POD-структуры фиксированного размера, поэтому секции читаются
+// одним блоком без разбора и могут проверяться и загружаться независимо.
+
+const char INDEX_MAGIC[8] = { 'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0' };
+const uint32_t INDEX_VERSION = 2;
+const uint64_t INDEX_ALIGNMENT = 8;
+
+enum class IndexSectionKind : uint32_t {
+    STOP_WORDS = 1,   // u64 количество, затем { u32 длина, байты } для каждого стоп-слова
+    DOCUMENTS = 2,    // IndexDocumentRecord[], по возрастанию id
+    TEXTS = 3,        // тексты документов подряд, в порядке DOCUMENTS
+    TERMS = 4,        // IndexTermRecord[], по возрастанию слова
+    POSTINGS = 5,     // IndexPostingRecord[], сгруппированы по словам, внутри по возрастанию id
+    FORWARD = 6,      // IndexForwardRecord[], сгруппированы по документам, внутри по возрастанию слова
+};
+
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t file_size;
+};
+
+struct IndexSectionEntry {
+    IndexSectionKind kind;
+    uint32_t reserved;
+    uint64_t offset;      // от начала файла
+    uint64_t size;        // в байтах
+    uint64_t checksum;    // ComputeIndexChecksum от содержимого секции
+};
+
+struct IndexDocumentRecord {
+    int32_t document_id;
+    int32_t rating;
+    int32_t status;
+    uint32_t word_count;      // число слов без стоп-слов, для моделей ранжирования
+    uint64_t text_offset;     // смещение в секции TEXTS
+    uint64_t text_size;
+    uint64_t forward_offset;  // индекс первой записи в секции FORWARD
+    uint64_t forward_count;
+};
+
+// слово хранится не отдельно, а как ссылка на его вхождение в тексте одного из документов
+struct IndexTermRecord {
+    uint64_t text_offset;     // смещение в секции TEXTS
+    uint32_t length;
+    uint32_t reserved;
+    uint64_t postings_offset; // индекс первой записи в секции POSTINGS
+    uint64_t postings_count;
+};
+
+struct IndexPostingRecord {
+    int32_t document_id;
+    uint32_t reserved;
+    double term_freq;
+};
+
+struct IndexForwardRecord {
+    uint64_t text_offset;     // вхождение слова в тексте самого документа
+    uint32_t term_index;      // номер записи в секции TERMS
+    uint32_t reserved;
+    double term_freq;
+};
+
+// FNV-1a, 64 бита, по 8-байтовым словам
+uint64_t ComputeIndexChecksum(std::string_view data);
+
+// диапазон [offset, offset + count) целиком внутри [0, size), без переполнения
+inline bool IsIndexRangeInside(uint64_t offset, uint64_t count, uint64_t size) {
+    return offset <= size && count <= size - offset;
+}
@@ -0,0 +1,73 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0);
+    }
+}
+
+void LatencyHistogram::Add(Duration latency) {
+    ++buckets_[BucketIndex(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)))];
+    ++count_;
+}
+
+void LatencyHistogram::Remove(Duration latency) {
+    --buckets_[BucketIndex(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)))];
+    --count_;
+}
+
+size_t LatencyHistogram::GetCount() const {
+    return count_.load();
+}
+
+LatencyHistogram::Duration LatencyHistogram::GetPercentile(double percent) const {
+    const size_t total = count_.load();
+    if (total == 0) {
+        return Duration(0);
+    }
+
+    // ранг искомого замера, считая с единицы
+    size_t rank = static_cast<size_t>(percent / 100.0 * total + 0.5);
+    rank = std::max<size_t>(rank, 1);
+
+    size_t seen = 0;
+    for (size_t index = 0; index < buckets_.size(); ++index) {
+        seen += buckets_[index].load();
+        if (seen >= rank) {
+            return Duration(BucketValue(index));
+        }
+    }
+    return Duration(BucketValue(buckets_.size() - 1));
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+
+    int exponent = SUB_BUCKET_BITS;
+    while (exponent < MAX_EXPONENT && (value >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+    if ((value >> (exponent + 1)) != 0) {
+        // всё, что больше 2^(MAX_EXPONENT + 1), попадает в последнюю корзину
+        return BUCKET_COUNT - 1;
+    }
+
+    const uint64_t sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+    return SUB_BUCKET_COUNT + (exponent - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT + static_cast<size_t>(sub_bucket);
+}
+
+uint64_t LatencyHistogram::BucketValue(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const int exponent = static_cast<int>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT) + SUB_BUCKET_BITS;
+    const uint64_t sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+    const uint64_t width = uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    const uint64_t lower = (SUB_BUCKET_COUNT + sub_bucket) * width;
+    return lower + width / 2;
+}
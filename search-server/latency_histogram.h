@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Компактная гистограмма задержек с логарифмическими корзинами.
+// Вместо хранения каждого замера считает попадания в корзины: на каждый
+// диапазон [2^e, 2^(e+1)) приходится 16 корзин, то есть погрешность перцентиля не более ~6%.
+// Поддерживает удаление замера, поэтому годится для скользящего окна.
+// Add/Remove потокобезопасны.
+class LatencyHistogram {
+public:
+    using Duration = std::chrono::microseconds;
+
+    LatencyHistogram();
+
+    void Add(Duration latency);
+
+    void Remove(Duration latency);
+
+    size_t GetCount() const;
+
+    // percent от 0 до 100, например 50.0, 95.0, 99.0
+    Duration GetPercentile(double percent) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;           // 2^40 мкс - около 12 суток
+    static const int BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_EXPONENT - SUB_BUCKET_BITS + 2);
+
+    std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets_;
+    std::atomic<size_t> count_ = 0;
+
+    static size_t BucketIndex(uint64_t value);
+
+    // середина диапазона корзины
+    static uint64_t BucketValue(size_t index);
+};
@@ -11,7 +11,9 @@
 #include "concurrent_map.h" // ускоренная мапа
 #include "remove_duplicates.h" // функционал поиска и удаления дубликатов
 #include "process_queries.h" // система параллельной обработки запросов
+#include "mapped_search_server.h" // поисковый сервер поверх отображаемого в память индекса
 #include "read_input_functions.h" // функции ввода данных
+#include "document_loader.h" // потоковая загрузка документов
 #include "test_example_functions.h" // модули тестовых запусков через try/catch
 #include "main_execution_tests.h" // используемые материалы для тестирования системы
 
@@ -76,5 +78,81 @@ int main() {
         BenchMark_FindDocumentsTest();
     }
 
+    {
+        // тесты доработок очереди запросов
+        ConcurrentQueueTest();
+        QueueTelemetryTest();
+    }
+
+    {
+        // тесты доработок: снимок индекса и индекс в отображаемом файле
+        IndexSnapshotTest();
+        MappedIndexTest();
+    }
+
+    {
+        // тесты доработок: хранилище текстов документов
+        TextArenaTest();
+    }
+
+    {
+        // тесты доработок: разбор строк на слова и стоп-слова
+        TokenizerTest();
+        StopWordsFilterTest();
+    }
+
+    {
+        // тесты доработок: потоковая загрузка документов
+        DocumentLoaderTest();
+    }
+
+    {
+        // тесты доработок: постраничная выдача
+        PaginationTest();
+    }
+
+    {
+        // тесты доработок: фильтры поиска
+        StatusPostingsTest();
+        DocumentFiltersTest();
+        RatingIndexTest();
+    }
+
+    {
+        // тесты доработок: фразовые, префиксные и нечёткие запросы
+        PhraseQueryTest();
+        PrefixQueryTest();
+        FuzzySearchTest();
+    }
+
+    {
+        // тесты доработок: модели ранжирования
+        Bm25ScoringTest();
+        ImpactIndexTest();
+        EarlyTerminationTest();
+    }
+
+    {
+        // тесты доработок: поиск дубликатов
+        RemoveDuplicatesTest();
+        NearDuplicatesTest();
+        DuplicatePolicyTest();
+    }
+
+    {
+        // тесты доработок: сопоставление запроса со всеми документами
+        BatchMatchDocumentsTest();
+    }
+
+    {
+        // тесты доработок: выбор политики выполнения по стоимости запроса
+        AutoExecutionTest();
+    }
+
+    {
+        // тесты доработок: подготовленные запросы
+        PreparedQueryTest();
+    }
+
     return 0;
 }
\ No newline at end of file
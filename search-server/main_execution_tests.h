@@ -8,6 +8,12 @@
 #include <vector>
 #include <cassert>
 #include <atomic>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <fstream>
+#include <sstream>
 #include "read_input_functions.h" //   
 #include "document.h" //  
 #include "paginator.h" //  
@@ -16,7 +22,11 @@
 #include "log_duration.h" // 
 #include "concurrent_map.h" //  
 #include "process_queries.h" //    
+#include "mapped_search_server.h" //       
+#include "document_loader.h" //   
 #include "remove_duplicates.h" //     
+#include "document_fingerprint.h" //  
+#include "near_duplicates.h" //  -
 #include "test_example_functions.h" //     try/catch
 
 
@@ -795,6 +805,10 @@ void BenchMark_MatchDocumentsTest() {
     MDTEST(par);
     std::cout << std::endl;
 
+    std::cout << "--------- Auto Policy MatchDocuments in progress --------" << std::endl;
+    MDTest("auto"sv, search_server, query, auto_execution);
+    std::cout << std::endl;
+
     std::cout << std::endl;
     std::cout << "-------- BenchMark MatchDocuments testing complete ------" << std::endl;
     std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
@@ -1214,9 +1228,2273 @@ void BenchMark_FindDocumentsTest() {
 
     FTEST(seq);
     FTEST(par);
+    FTest("auto"sv, search_server, queries, auto_execution);
 
 
     std::cout << std::endl;
     std::cout << "-------- BenchMark FindDocuments testing complete -------" << std::endl;
     std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
-}
\ No newline at end of file
+}
+
+void ConcurrentQueueTest() {
+    std::cout << "---------- Concurrent Queue testing in progress ---------" << std::endl << std::endl;
+
+    SearchServer search_server("and in at"s);
+    search_server.AddDocument(1, "curly cat curly tail", DocumentStatus::ACTUAL, { 7, 2, 7 });
+    search_server.AddDocument(2, "curly dog and fancy collar", DocumentStatus::ACTUAL, { 1, 2, 3 });
+    search_server.AddDocument(3, "big cat fancy collar", DocumentStatus::ACTUAL, { 1, 2, 8 });
+
+    RequestQueue request_queue(search_server);
+
+    //    
+    std::vector<std::string> queries;
+    for (int i = 0; i < 5000; ++i) {
+        queries.push_back(i % 2 ? "curly dog"s : "empty request"s);
+    }
+
+    std::for_each(std::execution::par, queries.begin(), queries.end(),
+        [&request_queue](const std::string& query) {
+            request_queue.AddFindRequest(query);
+        });
+
+    //    :       
+    int no_result = 0;
+    const int last_number = request_queue.GetQueryNumber() - 1;
+    for (int number = last_number - 1439; number <= last_number; ++number) {
+        const auto [query, result] = request_queue.GetResultByRequestNumber(number);
+        assert(!query.empty());
+        no_result += result.empty();
+    }
+
+    std::cout << "Total requests: "s << last_number << ", in window: "s << request_queue.GetQuerySize() << std::endl;
+    std::cout << "Total empty requests: "s << request_queue.GetNoResultRequests() << std::endl;
+
+    assert(last_number == 5000);
+    assert(request_queue.GetQuerySize() == 1440);
+    assert(no_result == request_queue.GetNoResultRequests());
+
+    std::cout << std::endl;
+    std::cout << "----------- Concurrent Queue testing complete -----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void QueueTelemetryTest() {
+    std::cout << "---------- Queue Telemetry testing in progress ----------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
+    }
+
+    const auto queries = GenerateQueries(generator, dictionary, 2000, 7);
+
+    RequestQueue request_queue(search_server);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (i % 2) {
+            request_queue.AddFindRequest(execution::par, queries[i]);
+        }
+        else {
+            request_queue.AddFindRequest(queries[i]);
+        }
+    }
+
+    const int last_number = request_queue.GetQueryNumber() - 1;
+    const auto last = request_queue.GetTelemetryByRequestNumber(last_number);
+    assert(last.has_value());
+    assert(last->policy == QueryPolicy::PARALLEL);
+    assert(last->matched_count >= request_queue.GetResultByRequestNumber(last_number).second.size());
+    assert(!request_queue.GetTelemetryByRequestNumber(1).has_value());
+
+    //        
+    request_queue.AddFindRequest(auto_execution, queries[0]);
+    const auto auto_request = request_queue.GetTelemetryByRequestNumber(request_queue.GetQueryNumber() - 1);
+    assert(auto_request.has_value() && auto_request->policy == QueryPolicy::AUTO);
+    request_queue.AddFindRequest(execution::seq, queries[1], DocumentStatus::ACTUAL);
+    assert(request_queue.GetTelemetryByRequestNumber(request_queue.GetQueryNumber() - 1)->policy == QueryPolicy::SEQUENCED);
+
+    std::cout << "Last request: latency = "s << last->latency.count() << " us, matched = "s
+        << last->matched_count << std::endl;
+
+    const WindowTelemetry telemetry = request_queue.GetWindowTelemetry();
+    assert(telemetry.request_count == 1440);
+    assert(telemetry.p50 <= telemetry.p95 && telemetry.p95 <= telemetry.p99);
+
+    std::cout << "Window: "s << telemetry.request_count << " requests, p50 = "s << telemetry.p50.count()
+        << " us, p95 = "s << telemetry.p95.count() << " us, p99 = "s << telemetry.p99.count()
+        << " us, throughput = "s << telemetry.throughput << " req/s"s << std::endl;
+
+    std::cout << std::endl;
+    std::cout << "------------ Queue Telemetry testing complete -----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+//   path  ,   mutate    kind,
+//     -  ,    
+template <typename Mutate>
+void WritePatchedSnapshot(const std::string& path, std::string snapshot, IndexSectionKind kind, Mutate mutate) {
+    IndexFileHeader header{};
+    std::memcpy(&header, snapshot.data(), sizeof(header));
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        char* entry_data = snapshot.data() + sizeof(header) + i * sizeof(IndexSectionEntry);
+        IndexSectionEntry entry{};
+        std::memcpy(&entry, entry_data, sizeof(entry));
+        if (entry.kind != kind) {
+            continue;
+        }
+        mutate(snapshot.data() + entry.offset);
+        entry.checksum = ComputeIndexChecksum(std::string_view(snapshot).substr(entry.offset, entry.size));
+        std::memcpy(entry_data, &entry, sizeof(entry));
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(snapshot.data(), snapshot.size());
+}
+
+void IndexSnapshotTest() {
+    std::cout << "---------- Index Snapshot testing in progress -----------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 7);
+
+    SearchServer search_server(dictionary[0] + " "s + dictionary[1]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i * 2, documents[i], static_cast<DocumentStatus>(i % 3), { 1, 2, static_cast<int>(i % 10) });
+    }
+
+    const std::string path = "search_server_snapshot.bin"s;
+    {
+        LOG_DURATION("Save"s);
+        search_server.Save(path);
+    }
+
+    std::optional<SearchServer> loaded;
+    {
+        LOG_DURATION("Load"s);
+        loaded.emplace(SearchServer::Load(path));
+    }
+
+    assert(loaded->GetDocumentCount() == search_server.GetDocumentCount());
+    assert(loaded->GetCurrentStopWords() == search_server.GetCurrentStopWords());
+    for (const int document_id : search_server) {
+        assert(loaded->GetWordFrequencies(document_id) == search_server.GetWordFrequencies(document_id));
+    }
+    for (const std::string& query : queries) {
+        const auto expected = search_server.FindTopDocuments(query);
+        const auto actual = loaded->FindTopDocuments(query);
+        assert(expected.size() == actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(expected[i].id == actual[i].id && expected[i].relevance == actual[i].relevance);
+        }
+    }
+    std::cout << "Loaded "s << loaded->GetDocumentCount() << " documents, results match"s << std::endl;
+
+    //    
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('#');
+    }
+    try {
+        SearchServer::Load(path);
+        assert(false);
+    }
+    catch (const std::runtime_error& e) {
+        std::cout << "Corrupted snapshot: "s << e.what() << std::endl;
+    }
+
+    //     ,      .
+    // mutate    ,   
+    search_server.Save(path);
+    std::string snapshot;
+    {
+        std::ifstream file(path, std::ios::binary);
+        snapshot.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto expect_rejected = [&path, &snapshot](IndexSectionKind kind, auto mutate) {
+        WritePatchedSnapshot(path, snapshot, kind, mutate);
+        try {
+            SearchServer::Load(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+    };
+    auto patch_document = [](auto field, auto value) {
+        return [field, value](char* data) {
+            IndexDocumentRecord record{};
+            std::memcpy(&record, data, sizeof(record));
+            record.*field = value;
+            std::memcpy(data, &record, sizeof(record));
+        };
+    };
+    expect_rejected(IndexSectionKind::DOCUMENTS, patch_document(&IndexDocumentRecord::status, 7));
+    expect_rejected(IndexSectionKind::DOCUMENTS, patch_document(&IndexDocumentRecord::text_offset, uint64_t{ 1 } << 40));
+    expect_rejected(IndexSectionKind::DOCUMENTS, patch_document(&IndexDocumentRecord::forward_offset, ~uint64_t{ 0 }));
+    expect_rejected(IndexSectionKind::FORWARD, [](char* data) {
+        IndexForwardRecord record{};
+        std::memcpy(&record, data, sizeof(record));
+        record.term_index = 1'000'000;
+        std::memcpy(data, &record, sizeof(record));
+        });
+    expect_rejected(IndexSectionKind::TERMS, [](char* data) {
+        IndexTermRecord record{};
+        std::memcpy(&record, data, sizeof(record));
+        record.postings_count = 1'000'000'000;
+        std::memcpy(data, &record, sizeof(record));
+        });
+    //     -   ,     
+    expect_rejected(IndexSectionKind::POSTINGS, [](char* data) {
+        IndexPostingRecord record{};
+        std::memcpy(&record, data, sizeof(record));
+        record.document_id = 1;
+        std::memcpy(data, &record, sizeof(record));
+        });
+    expect_rejected(IndexSectionKind::STOP_WORDS, [](char* data) {
+        const uint32_t length = 1'000'000;
+        std::memcpy(data + sizeof(uint64_t), &length, sizeof(length));
+        });
+    std::cout << "Inconsistent snapshots rejected"s << std::endl;
+    std::remove(path.c_str());
+
+    std::cout << std::endl;
+    std::cout << "------------ Index Snapshot testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void MappedIndexTest() {
+    std::cout << "----------- Mapped Index testing in progress ------------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], static_cast<DocumentStatus>(i % 2), { 1, 2, static_cast<int>(i % 10) });
+    }
+
+    const std::string path = "search_server_mapped.bin"s;
+    search_server.Save(path);
+
+    {
+        std::optional<MappedSearchServer> mapped;
+        {
+            LOG_DURATION("Open mapped index"s);
+            mapped.emplace(path);
+        }
+        assert(mapped->VerifyChecksums());
+        assert(mapped->GetDocumentCount() == search_server.GetDocumentCount());
+
+        for (int i = 0; i < 100; ++i) {
+            const string query = GenerateQueryWMinus(generator, dictionary, 5, 0.2);
+
+            const auto expected = search_server.FindTopDocuments(query);
+            const auto actual = mapped->FindTopDocuments(query);
+            assert(expected.size() == actual.size());
+            for (size_t j = 0; j < expected.size(); ++j) {
+                assert(expected[j].id == actual[j].id && expected[j].relevance == actual[j].relevance);
+            }
+
+            const int document_id = i * 97;
+            const auto [expected_words, expected_status] = search_server.MatchDocument(query, document_id);
+            const auto [actual_words, actual_status] = mapped->MatchDocument(query, document_id);
+            assert(expected_words == actual_words && expected_status == actual_status);
+        }
+        std::cout << "Mapped index results match in-memory index"s << std::endl;
+    }
+
+    //  :       ,    
+    std::string snapshot;
+    {
+        std::ifstream file(path, std::ios::binary);
+        snapshot.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto expect_rejected = [&path, &snapshot](IndexSectionKind kind, auto mutate) {
+        WritePatchedSnapshot(path, snapshot, kind, mutate);
+        try {
+            MappedSearchServer mapped(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+    };
+    expect_rejected(IndexSectionKind::STOP_WORDS, [](char* data) {
+        const uint64_t count = 1'000;
+        std::memcpy(data, &count, sizeof(count));
+        });
+    expect_rejected(IndexSectionKind::STOP_WORDS, [](char* data) {
+        const uint32_t length = 1'000'000;
+        std::memcpy(data + sizeof(uint64_t), &length, sizeof(length));
+        });
+    auto patch_term = [](auto field, auto value) {
+        return [field, value](char* data) {
+            IndexTermRecord record{};
+            std::memcpy(&record, data, sizeof(record));
+            record.*field = value;
+            std::memcpy(data, &record, sizeof(record));
+        };
+    };
+    expect_rejected(IndexSectionKind::TERMS, patch_term(&IndexTermRecord::postings_count, uint64_t{ 1'000'000'000 }));
+    expect_rejected(IndexSectionKind::TERMS, patch_term(&IndexTermRecord::postings_offset, ~uint64_t{ 0 }));
+    expect_rejected(IndexSectionKind::TERMS, patch_term(&IndexTermRecord::text_offset, uint64_t{ 1 } << 40));
+    expect_rejected(IndexSectionKind::DOCUMENTS, [](char* data) {
+        IndexDocumentRecord record{};
+        std::memcpy(&record, data, sizeof(record));
+        record.text_size = uint64_t{ 1 } << 40;
+        std::memcpy(data, &record, sizeof(record));
+        });
+
+    //          
+    WritePatchedSnapshot(path, snapshot, IndexSectionKind::POSTINGS, [](char* data) {
+        IndexPostingRecord record{};
+        std::memcpy(&record, data, sizeof(record));
+        record.document_id = -5;
+        std::memcpy(data, &record, sizeof(record));
+        });
+    {
+        const MappedSearchServer mapped(path);
+        const std::string first_word(search_server.GetMassive().begin()->first);
+        try {
+            mapped.FindTopDocuments(first_word);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    std::cout << "Corrupted mapped indexes rejected"s << std::endl;
+    std::remove(path.c_str());
+
+    std::cout << std::endl;
+    std::cout << "------------- Mapped Index testing complete -------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void TextArenaTest() {
+    std::cout << "------------ Text Arena testing in progress -------------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
+    }
+
+    const TextArena& texts = search_server.GetTextStorage();
+    std::cout << "Documents: "s << search_server.GetDocumentCount() << ", chunks: "s << texts.GetChunkCount()
+        << ", reserved: "s << texts.GetReservedBytes() << ", live: "s << texts.GetLiveBytes() << std::endl;
+
+    //           
+    SearchServer server_copy = search_server;
+    const string query = dictionary[1] + " "s + dictionary[2];
+    const auto expected = server_copy.FindTopDocuments(query);
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.RemoveDocument(i);
+    }
+    std::cout << "After remove: chunks: "s << texts.GetChunkCount() << ", reserved: "s << texts.GetReservedBytes()
+        << ", live: "s << texts.GetLiveBytes() << std::endl;
+    assert(texts.GetLiveBytes() == 0);
+    assert(texts.GetChunkCount() <= 1);
+    assert(search_server.GetMassive().empty());
+
+    const auto actual = server_copy.FindTopDocuments(query);
+    assert(expected.size() == actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(expected[i].id == actual[i].id);
+    }
+
+    std::cout << std::endl;
+    std::cout << "-------------- Text Arena testing complete --------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void TokenizerTest() {
+    std::cout << "------------- Tokenizer testing in progress -------------" << std::endl << std::endl;
+
+    //           
+    auto simple_split = [](std::string_view text) {
+        std::vector<std::string_view> words;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            if (text[pos] == ' ') {
+                ++pos;
+                continue;
+            }
+            const size_t end = std::min(text.find(' ', pos), text.size());
+            words.push_back(text.substr(pos, end - pos));
+            pos = end;
+        }
+        return words;
+    };
+
+    mt19937 generator;
+    for (int i = 0; i < 10000; ++i) {
+        std::string text(uniform_int_distribution(0, 100)(generator), 'a');
+        for (char& c : text) {
+            const int kind = uniform_int_distribution(0, 3)(generator);
+            c = kind == 0 ? ' ' : static_cast<char>('a' + kind);
+        }
+        std::vector<std::string_view> words;
+        assert(SplitIntoWordsValidated(text, words) == std::string_view::npos);
+        assert(words == simple_split(text));
+        assert(SplitIntoWords(std::string_view(text)) == words);
+    }
+
+    {
+        const std::string text = "  funny pet with cur\x12ly hair   and \x01 more"s;
+        std::vector<std::string_view> words;
+        const size_t invalid_pos = SplitIntoWordsValidated(text, words);
+        assert(invalid_pos == text.find('\x12'));
+        assert(GetWordAt(text, invalid_pos) == "cur\x12ly"sv);
+        assert(words.size() == 8);
+    }
+
+    {
+        SearchServer search_server("and with"s);
+        try {
+            search_server.AddDocument(1, "funny pet with cur\x12ly hair"s, DocumentStatus::ACTUAL, { 1 });
+            assert(false);
+        }
+        catch (const std::invalid_argument& e) {
+            std::cout << "AddDocument: "s << e.what() << std::endl;
+        }
+        assert(search_server.GetDocumentCount() == 0);
+
+        search_server.AddDocument(1, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1 });
+        try {
+            search_server.FindTopDocuments("curly -ha\x02ir"s);
+            assert(false);
+        }
+        catch (const std::invalid_argument& e) {
+            std::cout << "FindTopDocuments: "s << e.what() << std::endl;
+        }
+    }
+
+    std::cout << std::endl;
+    std::cout << "--------------- Tokenizer testing complete --------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void DocumentLoaderTest() {
+    std::cout << "---------- Document Loader testing in progress ----------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 70);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 7);
+
+    SearchServer expected_server(dictionary[0]);
+    const std::string path = "search_server_corpus.tsv"s;
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (size_t i = 0; i < documents.size(); ++i) {
+            out << i << '\t' << (i % 3 ? "ACTUAL"s : "1"s) << '\t' << i % 7 << ' ' << 3 << '\t' << documents[i] << '\n';
+            expected_server.AddDocument(i, documents[i], i % 3 ? DocumentStatus::ACTUAL : DocumentStatus::IRRELEVANT,
+                { static_cast<int>(i % 7), 3 });
+        }
+        //  :  ,  ,  id
+        out << "100500\tACTUAL\t1 2\n"s;
+        out << "100501\tUNKNOWN\t1\tfunny pet\n"s;
+        out << "0\tACTUAL\t1\tfunny pet"s;
+    }
+
+    SearchServer search_server(dictionary[0]);
+    for (const LoaderOptions& options : { LoaderOptions{ 0, 2, 8 }, LoaderOptions{ 1024, 2, 0 } }) {
+        try {
+            DocumentLoader(search_server, options);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+
+    LoaderOptions options;
+    options.chunk_size = 64 * 1024;
+    DocumentLoader loader(search_server, options);
+    {
+        LOG_DURATION("LoadFile"s);
+        loader.LoadFile(path);
+    }
+    std::remove(path.c_str());
+
+    const LoadProgress& progress = loader.GetProgress();
+    std::cout << "Read "s << progress.bytes_read << " bytes, parsed "s << progress.documents_parsed
+        << ", added "s << progress.documents_added << ", rejected "s << progress.documents_rejected << std::endl;
+
+    assert(progress.documents_added == documents.size());
+    assert(progress.documents_rejected == 3);
+    assert(search_server.GetDocumentCount() == expected_server.GetDocumentCount());
+    for (const std::string& query : queries) {
+        const auto expected = expected_server.FindTopDocuments(query);
+        const auto actual = search_server.FindTopDocuments(query);
+        assert(expected.size() == actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(expected[i].id == actual[i].id && expected[i].rating == actual[i].rating);
+        }
+    }
+
+    //   
+    {
+        SearchServer stream_server("and with"s);
+        std::istringstream input("1\tACTUAL\t5\tfunny pet and nasty rat\r\n2\tBANNED\t\tcurly hair"s);
+        DocumentLoader stream_loader(stream_server);
+        stream_loader.LoadStream(input);
+        assert(stream_server.GetDocumentCount() == 2);
+        assert(stream_server.FindTopDocuments("curly"s, DocumentStatus::BANNED).size() == 1);
+        assert(stream_server.FindTopDocuments("rat"s)[0].rating == 5);
+    }
+
+    //         :   id    
+    {
+        std::string corpus;
+        for (int i = 0; i < 2'000; ++i) {
+            corpus += std::to_string(i % 1'000) + "\tACTUAL\t1\t"s + (i < 1'000 ? "early"s : "late"s) + " w"s + std::to_string(i) + "\n"s;
+        }
+        LoaderOptions small_chunks;
+        small_chunks.chunk_size = 64;
+        small_chunks.parser_threads = 4;
+        for (int attempt = 0; attempt < 5; ++attempt) {
+            SearchServer ordered_server(""s);
+            std::istringstream input(corpus);
+            DocumentLoader ordered_loader(ordered_server, small_chunks);
+            ordered_loader.LoadStream(input);
+            assert(ordered_server.GetDocumentCount() == 1'000);
+            assert(ordered_loader.GetProgress().documents_rejected == 1'000);
+            for (int document_id = 0; document_id < 1'000; ++document_id) {
+                assert(ordered_server.GetWordFrequencies(document_id).count("early"sv) == 1);
+            }
+        }
+    }
+
+    //         
+    {
+        std::string long_text;
+        for (int i = 0; i < 100'000; ++i) {
+            long_text += "w"s + std::to_string(i % 5'000) + " "s;
+        }
+        SearchServer long_server(""s);
+        std::istringstream input("7\tACTUAL\t1\t"s + long_text + "\n8\tACTUAL\t2\tshort line\n"s);
+        LoaderOptions small_chunks;
+        small_chunks.chunk_size = 64;
+        DocumentLoader long_loader(long_server, small_chunks);
+        {
+            LOG_DURATION("LoadStream, one 590 KB line in 64-byte chunks"s);
+            long_loader.LoadStream(input);
+        }
+        assert(long_server.GetDocumentCount() == 2);
+        assert(long_server.GetWordFrequencies(7).size() == 5'000);
+    }
+
+    std::cout << std::endl;
+    std::cout << "------------ Document Loader testing complete -----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void StopWordsFilterTest() {
+    std::cout << "---------- Stop Words Filter testing in progress --------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 2000, 10);
+    const auto stop_words = MakeUniqueNonEmptyStrings(std::vector<std::string>(dictionary.begin(), dictionary.begin() + 1000));
+    const StopWordsFilter filter(stop_words);
+
+    //   ,       
+    for (const std::string& word : dictionary) {
+        assert(filter.Contains(word) == (stop_words.count(word) > 0));
+        const std::string_view prefix = std::string_view(word).substr(0, word.size() - 1);
+        assert(filter.Contains(prefix) == (stop_words.count(prefix) > 0));
+        const std::string longer = word + "z"s;
+        assert(filter.Contains(longer) == (stop_words.count(longer) > 0));
+    }
+    assert(!StopWordsFilter().Contains("and"sv));
+    assert(!filter.Contains(""sv));
+    //     
+    assert(filter.GetTableSize() == stop_words.size());
+
+    //        
+    {
+        const auto large_dictionary = GenerateDictionary(generator, 50'000, 12);
+        const auto large_stop_words = MakeUniqueNonEmptyStrings(
+            std::vector<std::string>(large_dictionary.begin(), large_dictionary.begin() + 25'000));
+        std::optional<StopWordsFilter> large_filter;
+        {
+            LOG_DURATION("StopWordsFilter build, 25000 words"s);
+            large_filter.emplace(large_stop_words);
+        }
+        assert(large_filter->GetTableSize() == large_stop_words.size());
+        for (const std::string& word : large_dictionary) {
+            assert(large_filter->Contains(word) == (large_stop_words.count(word) > 0));
+        }
+    }
+
+    const auto documents = GenerateQueries(generator, dictionary, 1'000, 1000);
+    std::vector<std::string_view> words;
+    for (const std::string& document : documents) {
+        SplitIntoWordsValidated(document, words);
+    }
+    size_t set_count = 0;
+    size_t filter_count = 0;
+    {
+        LOG_DURATION("std::set"s);
+        for (std::string_view word : words) {
+            set_count += stop_words.count(word);
+        }
+    }
+    {
+        LOG_DURATION("StopWordsFilter"s);
+        for (std::string_view word : words) {
+            filter_count += filter.Contains(word);
+        }
+    }
+    assert(set_count == filter_count);
+    std::cout << words.size() << " words checked, "s << filter_count << " stop words"s << std::endl;
+
+    std::cout << std::endl;
+    std::cout << "------------ Stop Words Filter testing complete ---------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void PaginationTest() {
+    std::cout << "-------------- Pagination testing in progress -----------" << std::endl << std::endl;
+
+    {
+        //    ,    
+        const std::vector<int> values = { 1, 2, 3, 4, 5, 6, 7 };
+        const auto pages = Paginate(values, 3);
+        assert(pages.size() == 3);
+        assert(pages.end() - pages.begin() == 3);
+        assert(*pages[1].begin() == 4 && pages[1].size() == 3);
+        assert(pages[2].size() == 1);
+        assert((*(pages.end() - 1)).size() == 1);
+        assert(Paginate(std::vector<int>{}, 3).size() == 0);
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 50);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { static_cast<int>(i % 97) });
+    }
+
+    const string query = dictionary[1] + " "s + dictionary[2] + " "s + dictionary[3];
+    const size_t page_size = 10;
+
+    //      
+    const DocumentsPage all = search_server.FindDocumentsPage(std::execution::seq, query, DocumentStatus::ACTUAL, 0, documents.size());
+    assert(all.documents.size() == all.total_count);
+    assert(std::is_sorted(all.documents.begin(), all.documents.end(), IsMoreRelevant));
+
+    const auto top = search_server.FindTopDocuments(query);
+    assert(top.size() == static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT));
+    for (size_t i = 0; i < top.size(); ++i) {
+        assert(top[i].id == all.documents[i].id);
+    }
+
+    //  1-50      
+    std::vector<Document> joined;
+    {
+        LOG_DURATION("50 pages"s);
+        for (size_t page_number = 0; page_number < 50; ++page_number) {
+            const DocumentsPage page = search_server.FindDocumentsPage(query, page_number * page_size, page_size);
+            assert(page.total_count == all.total_count);
+            joined.insert(joined.end(), page.documents.begin(), page.documents.end());
+        }
+    }
+    assert(joined.size() == std::min<size_t>(50 * page_size, all.total_count));
+    for (size_t i = 0; i < joined.size(); ++i) {
+        assert(joined[i].id == all.documents[i].id);
+    }
+
+    const DocumentsPage par_page = search_server.FindDocumentsPage(std::execution::par, query, DocumentStatus::ACTUAL, 20, page_size);
+    for (size_t i = 0; i < par_page.documents.size(); ++i) {
+        assert(par_page.documents[i].id == all.documents[20 + i].id);
+    }
+
+    //          id      
+    {
+        SearchServer tied_server(""s);
+        for (int document_id = 0; document_id < 300; ++document_id) {
+            tied_server.AddDocument(document_id * 3, "tied cat"s, DocumentStatus::ACTUAL, { 5 });
+        }
+        std::vector<int> ids;
+        for (size_t offset = 0; offset < 300; offset += 7) {
+            for (const Document& document : tied_server.FindDocumentsPage("cat"s, offset, 7).documents) {
+                ids.push_back(document.id);
+            }
+        }
+        assert(ids.size() == 300);
+        for (int i = 0; i < 300; ++i) {
+            assert(ids[i] == i * 3);
+        }
+    }
+
+    //     
+    assert(search_server.FindDocumentsPage(query, all.total_count, page_size).documents.empty());
+    std::cout << "Matched documents: "s << all.total_count << std::endl;
+
+    std::cout << std::endl;
+    std::cout << "---------------- Pagination testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void StatusPostingsTest() {
+    std::cout << "----------- Status Postings testing in progress ---------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 50);
+    const auto queries = GenerateQueries(generator, dictionary, 200, 7);
+
+    //    -    
+    const std::vector<DocumentStatus> statuses = { DocumentStatus::BANNED, DocumentStatus::BANNED, DocumentStatus::BANNED,
+        DocumentStatus::IRRELEVANT, DocumentStatus::ACTUAL };
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], statuses[i % statuses.size()], { static_cast<int>(i % 13) });
+    }
+
+    //         
+    const auto check = [&queries](const SearchServer& server) {
+        for (const std::string& query : queries) {
+            for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED, DocumentStatus::REMOVED }) {
+                const auto predicate = [status](int, DocumentStatus document_status, int) { return document_status == status; };
+                const auto expected = server.FindTopDocuments(std::execution::seq, query, predicate);
+                const auto seq_result = server.FindTopDocuments(std::execution::seq, query, status);
+                const auto par_result = server.FindTopDocuments(std::execution::par, query, status);
+                assert(seq_result.size() == expected.size() && par_result.size() == expected.size());
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    assert(std::abs(seq_result[i].relevance - expected[i].relevance) < RELEVANCE_THRESHOLD);
+                    assert(std::abs(par_result[i].relevance - expected[i].relevance) < RELEVANCE_THRESHOLD);
+                }
+                assert(server.FindDocumentsPage(std::execution::seq, query, status, 0, 1000).total_count
+                    == server.FindDocumentsPage(std::execution::seq, query, predicate, 0, 1000).total_count);
+            }
+        }
+    };
+    check(search_server);
+
+    {
+        LOG_DURATION("ACTUAL by predicate"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query,
+                [](int, DocumentStatus document_status, int) { return document_status == DocumentStatus::ACTUAL; });
+        }
+    }
+    {
+        LOG_DURATION("ACTUAL by status postings"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query, DocumentStatus::ACTUAL);
+        }
+    }
+
+    //    
+    for (size_t i = 0; i < documents.size(); i += 3) {
+        if (i % 2 == 0) {
+            search_server.RemoveDocument(i);
+        }
+        else {
+            search_server.RemoveDocument(std::execution::par, i);
+        }
+    }
+    check(search_server);
+
+    //       
+    const std::string path = "status_postings_test.idx"s;
+    search_server.Save(path);
+    const SearchServer loaded = SearchServer::Load(path);
+    std::remove(path.c_str());
+    check(loaded);
+
+    std::cout << std::endl;
+    std::cout << "------------- Status Postings testing complete ----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void DocumentFiltersTest() {
+    std::cout << "---------- Document Filters testing in progress ---------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 50);
+    const auto queries = GenerateQueries(generator, dictionary, 200, 7);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        //  id ,     
+        if (i % 7 == 3) {
+            continue;
+        }
+        search_server.AddDocument(i, documents[i], static_cast<DocumentStatus>(i % 3), { static_cast<int>(i % 21) - 10 });
+    }
+
+    //      ,    
+    const auto check = [&](const auto& filter, const std::string& query) {
+        const auto predicate = [&filter](int document_id, DocumentStatus status, int rating) {
+            return filter(document_id, status, rating);
+        };
+        const DocumentsPage expected = search_server.FindDocumentsPage(std::execution::seq, query, predicate, 0, 50);
+        const DocumentsPage seq_result = search_server.FindDocumentsPage(std::execution::seq, query, filter, 0, 50);
+        const DocumentsPage par_result = search_server.FindDocumentsPage(std::execution::par, query, filter, 0, 50);
+        assert(seq_result.total_count == expected.total_count && par_result.total_count == expected.total_count);
+        for (size_t i = 0; i < expected.documents.size(); ++i) {
+            assert(std::abs(seq_result.documents[i].relevance - expected.documents[i].relevance) < RELEVANCE_THRESHOLD);
+            assert(std::abs(par_result.documents[i].relevance - expected.documents[i].relevance) < RELEVANCE_THRESHOLD);
+        }
+    };
+
+    const IdIn some_ids({ 5, 1, 100, 2001, 17, 9999, 5, 14000 });
+    for (const std::string& query : queries) {
+        check(StatusIs(DocumentStatus::BANNED), query);
+        check(RatingRange(-2, 3), query);
+        check(IdModulo(2, 0), query);
+        check(some_ids, query);
+        check(StatusIs(DocumentStatus::ACTUAL) && RatingRange(0, 10), query);
+        check(IdModulo(3, 1) && RatingRange(-10, 0), query);
+        check(StatusIs(DocumentStatus::IRRELEVANT) && IdModulo(2, 1) && RatingRange(5, 5), query);
+    }
+    //      -     ,    
+    check(RatingRange(0, 5), dictionary.back());
+
+    try {
+        IdModulo(0, 0);
+        assert(false);
+    }
+    catch (const std::invalid_argument&) {
+    }
+
+    {
+        LOG_DURATION("Even ids by lambda"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query,
+                [](int document_id, DocumentStatus, int) { return document_id % 2 == 0; });
+        }
+    }
+    {
+        LOG_DURATION("Even ids by IdModulo"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query, IdModulo(2, 0));
+        }
+    }
+    {
+        LOG_DURATION("Positive rating by lambda"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query,
+                [](int, DocumentStatus, int rating) { return rating > 0; });
+        }
+    }
+    {
+        LOG_DURATION("Positive rating by RatingRange"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(std::execution::seq, query, RatingRange(1, std::numeric_limits<int>::max()));
+        }
+    }
+
+    //     
+    for (size_t i = 0; i < documents.size(); i += 5) {
+        if (i % 7 != 3) {
+            search_server.RemoveDocument(i);
+        }
+    }
+    for (const std::string& query : queries) {
+        check(StatusIs(DocumentStatus::ACTUAL) && RatingRange(-5, 5), query);
+    }
+
+    std::cout << std::endl;
+    std::cout << "------------ Document Filters testing complete ----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void RatingIndexTest() {
+    std::cout << "------------ Rating Index testing in progress -----------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 50);
+    const auto queries = GenerateQueries(generator, dictionary, 200, 7);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const int rating = uniform_int_distribution<int>(-100, 100)(generator);
+        search_server.AddDocument(i, documents[i], static_cast<DocumentStatus>(i % 2), { rating });
+    }
+
+    // :   ,   
+    const auto expected_by_rating = [&search_server](const std::string& query, DocumentStatus status) {
+        std::vector<Document> all = search_server.FindDocumentsPage(std::execution::seq, query, status, 0, 100'000).documents;
+        std::sort(all.begin(), all.end(), [](const Document& lhs, const Document& rhs) {
+            return lhs.rating > rhs.rating || (lhs.rating == rhs.rating && lhs.id < rhs.id);
+            });
+        all.resize(std::min<size_t>(all.size(), MAX_RESULT_DOCUMENT_COUNT));
+        return all;
+    };
+
+    const auto check = [&](const std::string& query, DocumentStatus status) {
+        const auto expected = expected_by_rating(query, status);
+        const auto result = search_server.FindTopDocumentsByRating(query, status);
+        assert(result.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(result[i].id == expected[i].id && result[i].rating == expected[i].rating);
+            assert(std::abs(result[i].relevance - expected[i].relevance) < RELEVANCE_THRESHOLD);
+        }
+    };
+
+    for (const std::string& query : queries) {
+        check(query, DocumentStatus::ACTUAL);
+        check(query, DocumentStatus::IRRELEVANT);
+        //    -  id    
+        const auto by_lambda = search_server.FindDocumentsPage(std::execution::seq, query,
+            [](int, DocumentStatus, int rating) { return rating >= 90 && rating <= 95; }, 0, 100);
+        const auto by_range = search_server.FindDocumentsPage(std::execution::seq, query, RatingRange(90, 95), 0, 100);
+        const auto by_range_status = search_server.FindDocumentsPage(std::execution::par, query,
+            RatingRange(90, 95) && StatusIs(DocumentStatus::ACTUAL), 0, 100);
+        assert(by_lambda.total_count == by_range.total_count);
+        assert(by_range_status.total_count <= by_range.total_count);
+        for (size_t i = 0; i < by_lambda.documents.size(); ++i) {
+            assert(std::abs(by_lambda.documents[i].relevance - by_range.documents[i].relevance) < RELEVANCE_THRESHOLD);
+        }
+    }
+    //        
+    check(dictionary.back(), DocumentStatus::ACTUAL);
+    assert(search_server.FindTopDocumentsByRating("unknownword"s).empty());
+
+    {
+        LOG_DURATION("Rating 90..95 by lambda"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(query, [](int, DocumentStatus, int rating) { return rating >= 90 && rating <= 95; });
+        }
+    }
+    {
+        LOG_DURATION("Rating 90..95 by RatingRange"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(query, RatingRange(90, 95));
+        }
+    }
+    {
+        LOG_DURATION("Top by relevance"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+    {
+        LOG_DURATION("Top by rating"s);
+        for (const std::string& query : queries) {
+            search_server.FindTopDocumentsByRating(query);
+        }
+    }
+
+    //     
+    for (size_t i = 0; i < documents.size(); i += 4) {
+        search_server.RemoveDocument(i);
+    }
+    for (const std::string& query : queries) {
+        check(query, DocumentStatus::ACTUAL);
+    }
+
+    std::cout << std::endl;
+    std::cout << "-------------- Rating Index testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void PhraseQueryTest() {
+    std::cout << "------------ Phrase Query testing in progress -----------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "white cat and fancy collar"s, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(2, "fancy white cat"s, DocumentStatus::ACTUAL, { 2 });
+        search_server.AddDocument(3, "cat white"s, DocumentStatus::ACTUAL, { 3 });
+
+        //      
+        try {
+            search_server.FindTopDocuments("\"white cat\""s);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        search_server.SetPositionalIndex(true);
+        const auto ids = [&search_server](const std::string& query) {
+            std::vector<int> result;
+            for (const Document& document : search_server.FindTopDocuments(query)) {
+                result.push_back(document.id);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+        assert((ids("\"white cat\""s) == std::vector<int>{ 1, 2 }));
+        assert((ids("\"cat white\""s) == std::vector<int>{ 3 }));
+        assert(ids("\"cat fancy\""s).empty());
+        assert((ids("\"cat and fancy\""s) == std::vector<int>{ 1 }));
+        assert((ids("\"cat fancy\"~1"s) == std::vector<int>{ 1 }));
+        assert((ids("\"white cat\" -collar"s) == std::vector<int>{ 2 }));
+        assert((ids("\"white cat\" \"fancy\""s) == std::vector<int>{ 1, 2 }));
+        assert((ids("\"and\" cat"s) == std::vector<int>{ 1, 2, 3 }));
+
+        const auto [seq_words, seq_status] = search_server.MatchDocument("\"white cat\" collar"s, 3);
+        assert(seq_words.empty());
+        const auto [par_words, par_status] = search_server.MatchDocument(std::execution::par, "\"white cat\" collar"s, 1);
+        assert(par_words.size() == 3);
+
+        for (const std::string& query : { "\"white cat"s, "white cat\""s, "\"white \"cat\"\""s, "\"white cat\"~"s,
+            "\"white cat\"~x"s, "\"white -cat\""s }) {
+            try {
+                search_server.FindTopDocuments(query);
+                assert(false);
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+
+        search_server.RemoveDocument(2);
+        assert((ids("\"white cat\""s) == std::vector<int>{ 1 }));
+    }
+
+    //         ~N:   ,
+    //        
+    {
+        SearchServer search_server(""s);
+        search_server.SetPositionalIndex(true);
+        std::string repeated;
+        for (int i = 0; i < 500; ++i) {
+            repeated += "a "s;
+        }
+        search_server.AddDocument(1, repeated, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(2, repeated + "b"s, DocumentStatus::ACTUAL, { 2 });
+        search_server.AddDocument(3, "b "s + repeated, DocumentStatus::ACTUAL, { 3 });
+        {
+            LOG_DURATION("Phrases over 500 repeated words"s);
+            std::vector<Document> found = search_server.FindTopDocuments("\"a a a a a a b\"~40"s);
+            assert(found.size() == 1 && found[0].id == 2);
+            found = search_server.FindTopDocuments("\"a a a a a a a a a a a a b\"~500"s);
+            assert(found.size() == 1 && found[0].id == 2);
+            // b   a:    
+            assert(std::get<0>(search_server.MatchDocument("\"a a a a a a b\"~40"s, 3)).empty());
+            const auto matches = search_server.MatchDocuments("\"a a a a a a a a a a a a a a a a a a a a b\"~60"s);
+            assert(matches[0].words.empty() && !matches[1].words.empty() && matches[2].words.empty());
+            // b   a     
+            const std::vector<Document> b_first = search_server.FindTopDocuments("\"b a a a a a a\"~20"s);
+            assert(b_first.size() == 1 && b_first[0].id == 3);
+            assert(search_server.FindTopDocuments("\"a b\"~1"s).size() == 1);
+        }
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 300, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 5'000, 50);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1 });
+    }
+    {
+        LOG_DURATION("Build positions"s);
+        search_server.SetPositionalIndex(true);
+    }
+    size_t postings_count = 0;
+    for (const auto& [word, postings] : search_server.GetMassive()) {
+        postings_count += postings.size();
+    }
+    std::cout << "Postings: "s << postings_count << ", positions: "s << search_server.GetPositionsByteSize() << " bytes"s << std::endl;
+
+    //         
+    std::vector<std::vector<std::string_view>> texts;
+    for (const std::string& document : documents) {
+        SplitIntoWordsValidated(document, texts.emplace_back());
+    }
+    size_t phrase_matches = 0;
+    {
+        LOG_DURATION("Phrase queries"s);
+        for (int i = 0; i < 300; ++i) {
+            const std::vector<std::string_view>& source = texts[uniform_int_distribution<size_t>(0, texts.size() - 1)(generator)];
+            if (source.size() < 2) {
+                continue;
+            }
+            const size_t start = uniform_int_distribution<size_t>(0, source.size() - 2)(generator);
+            if (source[start] == dictionary[0] || source[start + 1] == dictionary[0]) {
+                continue;
+            }
+            const std::string query = "\""s + std::string(source[start]) + " "s + std::string(source[start + 1]) + "\""s;
+
+            const DocumentsPage page = search_server.FindDocumentsPage(std::execution::par, query, DocumentStatus::ACTUAL, 0, texts.size());
+            size_t expected = 0;
+            for (const auto& text : texts) {
+                for (size_t j = 0; j + 1 < text.size(); ++j) {
+                    if (text[j] == source[start] && text[j + 1] == source[start + 1]) {
+                        ++expected;
+                        break;
+                    }
+                }
+            }
+            assert(page.total_count == expected);
+            phrase_matches += expected;
+        }
+    }
+    std::cout << "Phrase matches: "s << phrase_matches << std::endl;
+
+    std::cout << std::endl;
+    std::cout << "-------------- Phrase Query testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void PrefixQueryTest() {
+    std::cout << "------------ Prefix Query testing in progress -----------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "cat catalog"s, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(2, "cats and dogs"s, DocumentStatus::ACTUAL, { 2 });
+        search_server.AddDocument(3, "category of dogs"s, DocumentStatus::ACTUAL, { 3 });
+        search_server.AddDocument(4, "bird"s, DocumentStatus::ACTUAL, { 4 });
+
+        const auto result = search_server.FindTopDocuments("cat*"s);
+        assert(result.size() == 3);
+        //   -    : IDF     ,
+        //        ,  TF - 
+        const double inverse_document_freq = std::log(4.0 / 3.0);
+        assert(result[0].id == 1 && std::abs(result[0].relevance - inverse_document_freq) < RELEVANCE_THRESHOLD);
+        assert(result[1].id == 2 && std::abs(result[1].relevance - inverse_document_freq / 2.0) < RELEVANCE_THRESHOLD);
+        assert(result[2].id == 3 && std::abs(result[2].relevance - inverse_document_freq / 3.0) < RELEVANCE_THRESHOLD);
+
+        assert(search_server.FindTopDocuments("catalog*"s).size() == 1);
+        assert(search_server.FindTopDocuments("zebra*"s).empty());
+        assert(search_server.FindTopDocuments("dog* -cats*"s).size() == 1);
+        assert(search_server.FindTopDocuments("bird -categ*"s).size() == 1);
+
+        const auto [words, status] = search_server.MatchDocument(std::execution::par, "cat* bird"s, 1);
+        assert((words == std::vector<std::string_view>{ "cat"sv, "catalog"sv }));
+
+        for (const std::string& query : { "*"s, "-*"s, "ca**"s, "\"cat*\""s }) {
+            try {
+                search_server.FindTopDocuments(query);
+                assert(false);
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 50);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1 });
+    }
+
+    //   MAX_PREFIX_EXPANSION 
+    const auto [words, status] = search_server.MatchDocument("a* b* c*"s, 0);
+    assert(words.size() <= 3 * MAX_PREFIX_EXPANSION);
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string& word = dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)];
+        queries.push_back(word.substr(0, std::min<size_t>(word.size(), 3)) + "*"s);
+    }
+    size_t found = 0;
+    {
+        LOG_DURATION("Prefix queries"s);
+        for (const std::string& query : queries) {
+            found += search_server.FindTopDocuments(query).size();
+        }
+    }
+    assert(found > 0);
+
+    std::cout << std::endl;
+    std::cout << "-------------- Prefix Query testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void FuzzySearchTest() {
+    std::cout << "------------ Fuzzy Search testing in progress -----------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "curly cat"s, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(2, "fancy dog with collar"s, DocumentStatus::ACTUAL, { 2 });
+        search_server.AddDocument(3, "curly hair"s, DocumentStatus::ACTUAL, { 3 });
+
+        assert(search_server.FindTopDocuments("curli"s).empty());
+
+        search_server.SetFuzzySearch(1);
+        assert(search_server.FindTopDocuments("curli"s).size() == 2);
+        assert(search_server.FindTopDocuments("colar -curli"s).size() == 1);
+        assert(search_server.FindTopDocuments("cta"s).empty());
+
+        //      ,  -   
+        search_server.AddDocument(4, "big parrot"s, DocumentStatus::ACTUAL, { 4 });
+        assert(search_server.FindTopDocuments("parot"s).size() == 1);
+        search_server.RemoveDocument(4);
+        assert(search_server.FindTopDocuments("parot"s).empty());
+
+        search_server.SetFuzzySearch(2);
+        assert(search_server.FindTopDocuments("cta"s).size() == 1);
+        const auto [words, status] = search_server.MatchDocument("fancyy"s, 2);
+        assert((words == std::vector<std::string_view>{ "fancy"sv }));
+        //      
+        assert(search_server.MatchDocument(std::execution::par, "fancyy colar -cta"s, 2)
+            == search_server.MatchDocument(std::execution::seq, "fancyy colar -cta"s, 2));
+        assert(std::get<0>(search_server.MatchDocument(std::execution::par, "curli"s, 3)) == std::vector<std::string_view>{ "curly"sv });
+
+        try {
+            search_server.SetFuzzySearch(3);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+        assert(search_server.GetFuzzyDistance() == 2);
+        search_server.SetFuzzySearch(0);
+        assert(search_server.FindTopDocuments("cta"s).empty());
+    }
+
+    mt19937 generator;
+
+    //   -  
+    const auto misspell = [&generator](std::string word, int edits) {
+        for (int i = 0; i < edits; ++i) {
+            const int kind = uniform_int_distribution<int>(0, 2)(generator);
+            const size_t pos = uniform_int_distribution<size_t>(0, word.size())(generator);
+            const char letter = static_cast<char>(uniform_int_distribution<int>('a', 'z')(generator));
+            if (kind == 0 || word.size() < 2) {
+                word.insert(word.begin() + pos, letter);
+            }
+            else if (kind == 1) {
+                word.erase(std::min(pos, word.size() - 1), 1);
+            }
+            else {
+                word[std::min(pos, word.size() - 1)] = letter;
+            }
+        }
+        return word;
+    };
+
+    //      ,    
+    {
+        const auto dictionary = GenerateDictionary(generator, 5'000, 12);
+        for (int max_distance : { 1, 2 }) {
+            FuzzyIndex index(max_distance);
+            for (const std::string& word : dictionary) {
+                index.AddTerm(word);
+            }
+            for (int i = 0; i < 300; ++i) {
+                const std::string& source = dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)];
+                const std::string word = misspell(source, uniform_int_distribution<int>(1, max_distance)(generator));
+
+                std::vector<std::string_view> expected;
+                size_t best = max_distance + 1;
+                for (const std::string& term : dictionary) {
+                    std::vector<size_t> row(term.size() + 1);
+                    for (size_t j = 0; j <= term.size(); ++j) {
+                        row[j] = j;
+                    }
+                    for (size_t a = 1; a <= word.size(); ++a) {
+                        size_t diagonal = row[0];
+                        row[0] = a;
+                        for (size_t b = 1; b <= term.size(); ++b) {
+                            const size_t up = row[b];
+                            row[b] = std::min({ row[b] + 1, row[b - 1] + 1, diagonal + (word[a - 1] == term[b - 1] ? 0 : 1) });
+                            diagonal = up;
+                        }
+                    }
+                    if (row.back() < best) {
+                        best = row.back();
+                        expected.clear();
+                    }
+                    if (row.back() == best) {
+                        expected.push_back(term);
+                    }
+                }
+                assert(index.FindTerms(word, dictionary.size()) == expected);
+            }
+        }
+    }
+
+    //     
+    {
+        std::vector<std::string> vocabulary;
+        for (int i = 0; i < 200'000; ++i) {
+            vocabulary.push_back(GenerateWord(generator, 12));
+        }
+        FuzzyIndex index(2);
+        {
+            LOG_DURATION("Build deletion index, 200000 terms"s);
+            for (const std::string& word : vocabulary) {
+                index.AddTerm(word);
+            }
+        }
+        std::vector<std::string> queries;
+        for (int i = 0; i < 1000; ++i) {
+            queries.push_back(misspell(vocabulary[uniform_int_distribution<size_t>(0, vocabulary.size() - 1)(generator)], 2));
+        }
+        size_t found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const std::string& query : queries) {
+            found += index.FindTerms(query, MAX_FUZZY_EXPANSION).size();
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Average expansion: "s << elapsed.count() / queries.size() << " us, found "s << found << std::endl;
+        assert(found > 0);
+    }
+
+    std::cout << std::endl;
+    std::cout << "-------------- Fuzzy Search testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void Bm25ScoringTest() {
+    std::cout << "------------ BM25 Scoring testing in progress -----------" << std::endl << std::endl;
+
+    for (const auto& [k1, b] : { std::pair{ -1.0, 0.75 }, std::pair{ 1.2, -0.1 }, std::pair{ 1.2, 1.5 } }) {
+        try {
+            Bm25Scoring scoring(k1, b);
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "white cat"s, DocumentStatus::ACTUAL, { 8 });
+        search_server.AddDocument(2, "fluffy cat fluffy tail"s, DocumentStatus::ACTUAL, { 7 });
+        search_server.AddDocument(3, "groomed dog expressive eyes"s, DocumentStatus::ACTUAL, { 5 });
+        search_server.AddDocument(4, "groomed starling and eugene"s, DocumentStatus::ACTUAL, { 9 });
+
+        //    -  TF-IDF
+        assert(std::holds_alternative<TfIdfScoring>(search_server.GetScoring()));
+        const double tf_idf = search_server.FindTopDocuments("white"s)[0].relevance;
+        assert(std::abs(tf_idf - std::log(4.0) / 2.0) < RELEVANCE_THRESHOLD);
+
+        const Bm25Scoring scoring(1.2, 0.75);
+        search_server.SetScoring(scoring);
+
+        // count -  , length -   , document_freq -   
+        const auto bm25 = [&scoring](double count, double length, double document_freq, double document_count, double average_length) {
+            const double inverse_document_freq = std::log(1.0 + (document_count - document_freq + 0.5) / (document_freq + 0.5));
+            return inverse_document_freq * count * (scoring.k1 + 1.0)
+                / (count + scoring.k1 * (1.0 - scoring.b + scoring.b * length / average_length));
+        };
+
+        // -     : 2 + 4 + 4 + 3 
+        double average_length = 13.0 / 4.0;
+        std::map<int, double> expected = {
+            { 1, bm25(1, 2, 2, 4, average_length) },
+            { 2, bm25(2, 4, 1, 4, average_length) + bm25(1, 4, 2, 4, average_length) },
+            { 3, bm25(1, 4, 2, 4, average_length) },
+            { 4, bm25(1, 3, 2, 4, average_length) },
+        };
+        const auto check = [&expected](const std::vector<Document>& documents, size_t expected_count) {
+            assert(documents.size() == expected_count);
+            for (const Document& document : documents) {
+                assert(std::abs(document.relevance - expected.at(document.id)) < RELEVANCE_THRESHOLD);
+            }
+        };
+
+        const std::string query = "fluffy groomed cat"s;
+        check(search_server.FindTopDocuments(query), 4);
+        check(search_server.FindTopDocuments(std::execution::par, query), 4);
+        check(search_server.FindTopDocuments(std::execution::par, query,
+            [](int, DocumentStatus, int rating) { return rating > 6; }), 3);
+        check(search_server.FindTopDocuments(query, [](int, DocumentStatus, int rating) { return rating > 6; }), 3);
+        check(search_server.FindTopDocuments(query, IdModulo(2, 0)), 2);
+        check(search_server.FindTopDocuments(std::execution::par, query, IdModulo(2, 0)), 2);
+        check(search_server.FindDocumentsPage(std::execution::seq, query, DocumentStatus::ACTUAL, 1, 2).documents, 2);
+        check(search_server.FindTopDocumentsByRating(query), 4);
+        assert(search_server.FindTopDocumentsByRating(query)[0].id == 4);
+        check(search_server.FindTopDocuments("fluff* cat"s), 2);
+
+        //  id:     ,    id
+        {
+            SearchServer sparse_server("and with"s);
+            std::map<int, double> sparse_expected;
+            const std::vector<std::string> texts = { "white cat"s, "fluffy cat fluffy tail"s,
+                "groomed dog expressive eyes"s, "groomed starling and eugene"s };
+            for (int document_id = 1; document_id <= 4; ++document_id) {
+                const int sparse_id = document_id * 1'000'000;
+                sparse_server.AddDocument(sparse_id, texts[document_id - 1], DocumentStatus::ACTUAL, { 1 });
+                sparse_expected[sparse_id] = expected.at(document_id);
+            }
+            sparse_server.SetScoring(scoring);
+            std::swap(expected, sparse_expected);
+            check(sparse_server.FindTopDocuments(query), 4);
+            check(sparse_server.FindTopDocuments(std::execution::par, query, IdModulo(2, 0)), 4);
+            check(sparse_server.FindTopDocuments(query, [](int, DocumentStatus, int) { return true; }), 4);
+            std::swap(expected, sparse_expected);
+        }
+        //       ,   -  BM25
+        const auto result = search_server.FindTopDocuments(query);
+        assert(std::is_sorted(result.begin(), result.end(), IsMoreRelevant));
+        assert(result[0].id == 2);
+
+        //     ,   - 
+        const std::string path = "bm25_scoring_test.idx"s;
+        search_server.Save(path);
+        SearchServer loaded = SearchServer::Load(path);
+        std::remove(path.c_str());
+        assert(std::holds_alternative<TfIdfScoring>(loaded.GetScoring()));
+        loaded.SetScoring(scoring);
+        check(loaded.FindTopDocuments(query), 4);
+
+        //      ,   
+        search_server.RemoveDocument(4);
+        average_length = 10.0 / 3.0;
+        expected = {
+            { 1, bm25(1, 2, 2, 3, average_length) },
+            { 2, bm25(2, 4, 1, 3, average_length) + bm25(1, 4, 2, 3, average_length) },
+            { 3, bm25(1, 4, 1, 3, average_length) },
+        };
+        check(search_server.FindTopDocuments(query), 3);
+        check(search_server.FindTopDocuments(std::execution::par, query), 3);
+
+        search_server.SetScoring(TfIdfScoring{});
+        assert(std::abs(search_server.FindTopDocuments("white"s)[0].relevance - std::log(3.0) / 2.0) < RELEVANCE_THRESHOLD);
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 70);
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 7);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
+    }
+
+    //      
+    search_server.SetScoring(Bm25Scoring{});
+    for (size_t i = 0; i < 50; ++i) {
+        const auto seq_result = search_server.FindTopDocuments(queries[i]);
+        const auto par_result = search_server.FindTopDocuments(std::execution::par, queries[i]);
+        assert(seq_result.size() == par_result.size());
+        for (size_t j = 0; j < seq_result.size(); ++j) {
+            assert(seq_result[j].id == par_result[j].id);
+            assert(std::abs(seq_result[j].relevance - par_result[j].relevance) < RELEVANCE_THRESHOLD);
+        }
+    }
+
+    const auto run = [&search_server, &queries](const std::string& name) {
+        double total_relevance = 0.0;
+        LOG_DURATION(name);
+        for (const std::string& query : queries) {
+            for (const Document& document : search_server.FindTopDocuments(query)) {
+                total_relevance += document.relevance;
+            }
+        }
+        return total_relevance;
+    };
+    search_server.SetScoring(TfIdfScoring{});
+    assert(run("TF-IDF"s) > 0.0);
+    search_server.SetScoring(Bm25Scoring{});
+    assert(run("BM25"s) > 0.0);
+
+    std::cout << std::endl;
+    std::cout << "-------------- BM25 Scoring testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void ImpactIndexTest() {
+    std::cout << "------------ Impact Index testing in progress -----------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(1, "white cat and fashionable collar"s, DocumentStatus::ACTUAL, { 8, -3 });
+        search_server.AddDocument(2, "fluffy cat fluffy tail"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        search_server.AddDocument(3, "groomed dog expressive eyes"s, DocumentStatus::ACTUAL, { 5, -12, 2, 1 });
+        search_server.AddDocument(4, "groomed starling eugene"s, DocumentStatus::BANNED, { 9 });
+
+        const std::string query = "fluffy groomed cat -collar"s;
+        const auto expected = search_server.FindTopDocuments(query);
+        search_server.BuildImpactIndex();
+        assert(search_server.HasImpactIndex() && search_server.GetImpactIndexByteSize() > 0);
+
+        const auto result = search_server.FindTopDocuments(query);
+        assert(result.size() == expected.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            assert(result[i].id == expected[i].id && std::abs(result[i].relevance - expected[i].relevance) < RELEVANCE_THRESHOLD);
+        }
+        assert(search_server.FindTopDocuments(query, DocumentStatus::BANNED).size() == 1);
+        assert(search_server.FindTopDocuments("parrot"s).empty());
+
+        //       
+        search_server.AddDocument(5, "fluffy parrot"s, DocumentStatus::ACTUAL, { 1 });
+        assert(!search_server.HasImpactIndex());
+        assert(search_server.FindTopDocuments("parrot"s).size() == 1);
+        search_server.BuildImpactIndex();
+        search_server.RemoveDocument(5);
+        assert(!search_server.HasImpactIndex());
+        search_server.BuildImpactIndex();
+        search_server.SetScoring(Bm25Scoring{});
+        assert(!search_server.HasImpactIndex());
+    }
+
+    //            id,    
+    {
+        SearchServer search_server(""s);
+        for (int document_id = 0; document_id < 60; ++document_id) {
+            search_server.AddDocument(100 - document_id, document_id % 2 == 0 ? "cat dog"s : "cat parrot"s,
+                document_id % 3 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { 1 });
+        }
+        const std::vector<std::string> queries = { "cat"s, "dog"s, "cat dog"s, "cat -parrot"s, "parrot dog"s };
+        const auto check = [&search_server, &queries](DocumentStatus status) {
+            std::vector<std::vector<Document>> expected;
+            for (const std::string& query : queries) {
+                expected.push_back(search_server.FindTopDocuments(query, status));
+            }
+            search_server.BuildImpactIndex();
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const auto result = search_server.FindTopDocuments(queries[i], status);
+                assert(result.size() == expected[i].size());
+                for (size_t j = 0; j < result.size(); ++j) {
+                    assert(result[j].id == expected[i][j].id);
+                }
+            }
+        };
+        check(DocumentStatus::ACTUAL);
+        check(DocumentStatus::BANNED);
+        search_server.SetScoring(Bm25Scoring{});
+        check(DocumentStatus::ACTUAL);
+        check(DocumentStatus::BANNED);
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 70);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 1'000; ++i) {
+        queries.push_back(GenerateQueryWMinus(generator, dictionary, uniform_int_distribution(1, 7)(generator), 0.1));
+    }
+
+    SearchServer search_server(dictionary[0]);
+    size_t posting_count = 0;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], i % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL,
+            { static_cast<int>(i % 7) });
+        posting_count += search_server.GetWordFrequencies(i).size();
+    }
+
+    //          id    
+    const auto check = [&search_server, &queries](DocumentStatus status) {
+        std::vector<std::vector<Document>> expected;
+        std::vector<size_t> expected_counts;
+        for (const std::string& query : queries) {
+            size_t matched_count = 0;
+            expected.push_back(search_server.FindTopDocuments(std::execution::seq, query, status, matched_count));
+            expected_counts.push_back(matched_count);
+        }
+        search_server.BuildImpactIndex();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            size_t matched_count = 0;
+            const auto result = search_server.FindTopDocuments(std::execution::seq, queries[i], status, matched_count);
+            assert(matched_count == expected_counts[i]);
+            assert(result.size() == expected[i].size());
+            for (size_t j = 0; j < result.size(); ++j) {
+                assert(result[j].id == expected[i][j].id);
+                assert(std::abs(result[j].relevance - expected[i][j].relevance) < RELEVANCE_THRESHOLD);
+            }
+        }
+    };
+    check(DocumentStatus::ACTUAL);
+    check(DocumentStatus::BANNED);
+    search_server.SetScoring(Bm25Scoring{});
+    check(DocumentStatus::ACTUAL);
+
+    std::cout << "Postings: "s << posting_count * sizeof(std::pair<int, double>) << " bytes, impacts: "s
+        << search_server.GetImpactIndexByteSize() << " bytes"s << std::endl;
+    assert(search_server.GetImpactIndexByteSize() * 2 < posting_count * sizeof(std::pair<int, double>));
+
+    const auto run = [&search_server, &queries](const std::string& name) {
+        size_t found = 0;
+        LOG_DURATION(name);
+        for (const std::string& query : queries) {
+            found += search_server.FindTopDocuments(query).size();
+        }
+        return found;
+    };
+    const size_t found = run("Impact index"s);
+    search_server.SetScoring(Bm25Scoring{});
+    assert(run("Exact scoring"s) == found);
+
+    std::cout << std::endl;
+    std::cout << "-------------- Impact Index testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void EarlyTerminationTest() {
+    std::cout << "---------- Early Termination testing in progress --------" << std::endl << std::endl;
+
+    mt19937 generator;
+
+    //      ,   
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    std::vector<std::string> common_words;
+    for (int i = 0; i < 5; ++i) {
+        common_words.push_back("common"s + std::to_string(i));
+    }
+    std::vector<std::string> documents = GenerateQueries(generator, dictionary, 50'000, 40);
+    for (std::string& document : documents) {
+        for (const std::string& word : common_words) {
+            const int count = uniform_int_distribution(0, 4)(generator);
+            for (int i = 0; i < count; ++i) {
+                document += " "s + word;
+            }
+        }
+    }
+
+    SearchServer search_server(""s);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], i % 10 == 0 ? DocumentStatus::IRRELEVANT : DocumentStatus::ACTUAL,
+            { static_cast<int>(i % 3) });
+    }
+
+    std::vector<std::string> queries;
+    for (const std::string& word : common_words) {
+        queries.push_back(word);
+        queries.push_back(word + " "s + dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)]);
+        queries.push_back(word + " -"s + dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)]);
+        queries.push_back(word + " "s + common_words[(uniform_int_distribution<size_t>(1, 4)(generator) + queries.size()) % 5]);
+    }
+    for (int i = 0; i < 20; ++i) {
+        queries.push_back(GenerateQueryWMinus(generator, dictionary, 2, 0.3));
+    }
+
+    //        id    
+    const auto check = [&search_server, &queries](DocumentStatus status) {
+        std::vector<std::vector<Document>> expected;
+        std::vector<size_t> expected_counts;
+        for (const std::string& query : queries) {
+            expected.push_back(search_server.FindTopDocuments(query, status));
+            search_server.FindTopDocuments(std::execution::seq, query, status, expected_counts.emplace_back());
+        }
+        search_server.BuildImpactIndex();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const auto result = search_server.FindTopDocuments(queries[i], status);
+            assert(result.size() == expected[i].size());
+            for (size_t j = 0; j < result.size(); ++j) {
+                assert(result[j].id == expected[i][j].id);
+                assert(std::abs(result[j].relevance - expected[i][j].relevance) < RELEVANCE_THRESHOLD);
+            }
+            //          
+            size_t matched_count = 0;
+            search_server.FindTopDocuments(std::execution::seq, queries[i], status, matched_count);
+            assert(matched_count == expected_counts[i]);
+        }
+    };
+    check(DocumentStatus::ACTUAL);
+    check(DocumentStatus::IRRELEVANT);
+    search_server.SetScoring(Bm25Scoring{});
+    check(DocumentStatus::ACTUAL);
+
+    const auto run = [&search_server, &common_words](const std::string& name) {
+        size_t found = 0;
+        LOG_DURATION(name);
+        for (int i = 0; i < 10; ++i) {
+            for (const std::string& word : common_words) {
+                found += search_server.FindTopDocuments(word).size();
+            }
+        }
+        return found;
+    };
+    const size_t found = run("Common words, impact order"s);
+    search_server.SetScoring(Bm25Scoring{});
+    assert(run("Common words, exact"s) == found);
+
+    std::cout << std::endl;
+    std::cout << "------------ Early Termination testing complete ---------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void RemoveDuplicatesTest() {
+    std::cout << "--------- Remove Duplicates testing in progress ---------" << std::endl << std::endl;
+
+    {
+        // id   ,     id
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(100, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7 });
+        search_server.AddDocument(7, "nasty rat funny pet"s, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(5000, "funny funny pet with nasty rat"s, DocumentStatus::BANNED, { 2 });
+        search_server.AddDocument(42, "funny pet and not very nasty rat"s, DocumentStatus::ACTUAL, { 3 });
+        search_server.AddDocument(3, "and with"s, DocumentStatus::ACTUAL, { 4 });
+        search_server.AddDocument(4, "with and"s, DocumentStatus::ACTUAL, { 4 });
+
+        RemoveDuplicates(search_server);
+        //      
+        assert((std::vector<int>(search_server.begin(), search_server.end()) == std::vector<int>{ 3, 4, 7, 42 }));
+    }
+
+    {
+        DocumentFingerprint lhs;
+        DocumentFingerprint rhs;
+        for (std::string_view word : { "curly"sv, "cat"sv, "tail"sv }) {
+            lhs.AddWord(word);
+        }
+        for (std::string_view word : { "tail"sv, "curly"sv, "cat"sv }) {
+            rhs.AddWord(word);
+        }
+        assert(lhs == rhs);
+        rhs.AddWord("dog"sv);
+        assert(lhs != rhs);
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 100'000, 30);
+
+    //          
+    SearchServer search_server(dictionary[0]);
+    std::set<std::vector<std::string>> word_sets;
+    std::vector<int> expected_ids;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        std::vector<std::string> words = SplitIntoWords(texts[i % 5 == 4 ? i - 3 : i]);
+        std::shuffle(words.begin(), words.end(), generator);
+        std::string text;
+        for (const std::string& word : words) {
+            text += word + " "s;
+        }
+        const int document_id = static_cast<int>(i * 3 + 1);
+        search_server.AddDocument(document_id, text, DocumentStatus::ACTUAL, { 1 });
+
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        words.erase(std::remove(words.begin(), words.end(), dictionary[0]), words.end());
+        if (words.empty() || word_sets.insert(words).second) {
+            expected_ids.push_back(document_id);
+        }
+    }
+
+    std::streambuf* output = std::cout.rdbuf(nullptr);
+    {
+        LOG_DURATION("Remove duplicates, 100000 documents"s);
+        RemoveDuplicates(search_server);
+    }
+    std::cout.rdbuf(output);
+    assert(std::vector<int>(search_server.begin(), search_server.end()) == expected_ids);
+
+    std::cout << std::endl;
+    std::cout << "----------- Remove Duplicates testing complete ----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void NearDuplicatesTest() {
+    std::cout << "---------- Near Duplicates testing in progress ----------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        search_server.AddDocument(10, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7 });
+        search_server.AddDocument(4, "funny pet with curly rat"s, DocumentStatus::ACTUAL, { 1 });
+        search_server.AddDocument(30, "big dog in the city"s, DocumentStatus::ACTUAL, { 2 });
+        search_server.AddDocument(2, "and with"s, DocumentStatus::ACTUAL, { 3 });
+        search_server.AddDocument(3, "with and"s, DocumentStatus::ACTUAL, { 3 });
+
+        // funny pet rat    -  3 / 5
+        assert(FindNearDuplicates(search_server).empty());
+        const auto pairs = FindNearDuplicates(search_server, { 0.6, 32, 2 });
+        assert(pairs.size() == 1);
+        assert(pairs[0].original_id == 4 && pairs[0].duplicate_id == 10);
+        assert(std::abs(pairs[0].similarity - 0.6) < 1e-9);
+
+        for (const NearDuplicateOptions& options : { NearDuplicateOptions{ 0.0, 16, 4 }, NearDuplicateOptions{ 1.5, 16, 4 },
+            NearDuplicateOptions{ 0.8, 0, 4 }, NearDuplicateOptions{ 0.8, 16, 0 } }) {
+            try {
+                FindNearDuplicates(search_server, options);
+                assert(false);
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+
+        std::streambuf* output = std::cout.rdbuf(nullptr);
+        RemoveNearDuplicates(search_server, { 0.6, 32, 2 });
+        std::cout.rdbuf(output);
+        //     
+        assert((std::vector<int>(search_server.begin(), search_server.end()) == std::vector<int>{ 2, 3, 4, 30 }));
+    }
+
+    mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+
+    //           
+    auto create_server = [&generator, &dictionary](size_t document_count) {
+        SearchServer search_server(""s);
+        std::vector<std::string> texts;
+        for (size_t i = 0; i < document_count; ++i) {
+            if (i % 5 == 4) {
+                std::vector<std::string> words = SplitIntoWords(texts[i - 3]);
+                words[uniform_int_distribution<size_t>(0, words.size() - 1)(generator)]
+                    = dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)];
+                std::shuffle(words.begin(), words.end(), generator);
+                std::string text;
+                for (const std::string& word : words) {
+                    text += word + " "s;
+                }
+                texts.push_back(text);
+            }
+            else {
+                texts.push_back(GenerateQueryWMinus(generator, dictionary, 30));
+            }
+            search_server.AddDocument(static_cast<int>(i * 2 + 1), texts.back(), DocumentStatus::ACTUAL, { 1 });
+        }
+        return search_server;
+    };
+
+    auto jaccard = [](const SearchServer& search_server, int lhs_id, int rhs_id) {
+        std::vector<std::string_view> lhs, rhs, common;
+        for (const auto& [word, _] : search_server.GetWordFrequencies(lhs_id)) {
+            lhs.push_back(word);
+        }
+        for (const auto& [word, _] : search_server.GetWordFrequencies(rhs_id)) {
+            rhs.push_back(word);
+        }
+        std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(common));
+        return static_cast<double>(common.size()) / static_cast<double>(lhs.size() + rhs.size() - common.size());
+    };
+
+    {
+        //     
+        const SearchServer search_server = create_server(2'000);
+        const std::vector<int> ids(search_server.begin(), search_server.end());
+        std::vector<std::pair<int, int>> expected;
+        std::vector<int> kept;
+        for (int id : ids) {
+            const auto original = std::find_if(kept.begin(), kept.end(),
+                [&](int kept_id) { return jaccard(search_server, kept_id, id) >= 0.8; });
+            if (original != kept.end()) {
+                expected.push_back({ *original, id });
+            }
+            else {
+                kept.push_back(id);
+            }
+        }
+
+        std::vector<std::pair<int, int>> found;
+        for (const NearDuplicatePair& pair : FindNearDuplicates(search_server)) {
+            assert(std::abs(pair.similarity - jaccard(search_server, pair.original_id, pair.duplicate_id)) < 1e-9);
+            found.push_back({ pair.original_id, pair.duplicate_id });
+        }
+        assert(!expected.empty());
+        assert(found == expected);
+    }
+
+    {
+        SearchServer search_server = create_server(100'000);
+        std::vector<NearDuplicatePair> pairs;
+        {
+            LOG_DURATION("Find near duplicates, 100000 documents"s);
+            pairs = FindNearDuplicates(search_server);
+        }
+        //    ,      0.9 
+        for (const NearDuplicatePair& pair : pairs) {
+            assert(pair.duplicate_id == pair.original_id + 6);
+            assert(pair.similarity >= 0.8);
+        }
+        assert(pairs.size() >= 19'900 && pairs.size() <= 20'000);
+    }
+
+    std::cout << std::endl;
+    std::cout << "----------- Near Duplicates testing complete ------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void DuplicatePolicyTest() {
+    std::cout << "---------- Duplicate Policy testing in progress ---------" << std::endl << std::endl;
+
+    {
+        SearchServer search_server("and with"s);
+        assert(search_server.GetDuplicatePolicy() == DuplicatePolicy::ALLOW);
+        assert(search_server.AddDocument(5, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7 }) == 5);
+        assert(search_server.AddDocument(3, "nasty rat funny pet"s, DocumentStatus::ACTUAL, { 1 }) == 3);
+        search_server.AddDocument(8, "and with"s, DocumentStatus::ACTUAL, { 1 });
+
+        //      ,  -   id
+        search_server.SetDuplicatePolicy(DuplicatePolicy::SKIP);
+        assert(search_server.AddDocument(10, "rat rat pet nasty funny with"s, DocumentStatus::BANNED, { 2 }) == 3);
+        assert(search_server.GetDocumentCount() == 3);
+        assert(search_server.AddDocument(11, "rat pet nasty"s, DocumentStatus::ACTUAL, { 2 }) == 11);
+        //      
+        assert(search_server.AddDocument(12, "with with and"s, DocumentStatus::ACTUAL, { 2 }) == 12);
+
+        search_server.SetDuplicatePolicy(DuplicatePolicy::REJECT);
+        try {
+            search_server.AddDocument(13, "nasty pet rat"s, DocumentStatus::ACTUAL, { 2 });
+            assert(false);
+        }
+        catch (const std::invalid_argument&) {
+        }
+        assert(search_server.GetDocumentCount() == 5);
+        assert(search_server.FindTopDocuments("nasty"s).size() == 3);
+
+        //     ,  
+        search_server.RemoveDocument(3);
+        search_server.SetDuplicatePolicy(DuplicatePolicy::RECORD);
+        assert(search_server.AddDocument(1, "funny rat nasty pet"s, DocumentStatus::ACTUAL, { 2 }) == 1);
+        search_server.RemoveDocument(std::execution::par, 5);
+        assert(search_server.AddDocument(2, "funny rat pet nasty"s, DocumentStatus::ACTUAL, { 2 }) == 2);
+        search_server.RemoveDocuments({ 11 });
+        search_server.AddDocument(4, "nasty pet rat"s, DocumentStatus::ACTUAL, { 2 });
+
+        const auto& records = search_server.GetDuplicateRecords();
+        assert(records.size() == 2);
+        assert(records[0].document_id == 1 && records[0].original_id == 5);
+        assert(records[1].document_id == 2 && records[1].original_id == 1);
+        search_server.ClearDuplicateRecords();
+        assert(search_server.GetDuplicateRecords().empty());
+
+        search_server.SetDuplicatePolicy(DuplicatePolicy::ALLOW);
+        search_server.AddDocument(20, "funny rat pet nasty"s, DocumentStatus::ACTUAL, { 2 });
+        assert((std::vector<int>(search_server.begin(), search_server.end()) == std::vector<int>{ 1, 2, 4, 8, 12, 20 }));
+    }
+
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 100'000, 30);
+    //       
+    auto document_text = [&texts](size_t i) -> const std::string& {
+        return texts[i % 5 == 4 ? i - 3 : i];
+    };
+
+    //       ,   RemoveDuplicates 
+    SearchServer sweep_server(dictionary[0]);
+    {
+        LOG_DURATION("Add 100000 documents, then remove duplicates"s);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            sweep_server.AddDocument(static_cast<int>(i), document_text(i), DocumentStatus::ACTUAL, { 1 });
+        }
+        std::streambuf* output = std::cout.rdbuf(nullptr);
+        RemoveDuplicates(sweep_server);
+        std::cout.rdbuf(output);
+    }
+
+    SearchServer search_server(dictionary[0]);
+    search_server.SetDuplicatePolicy(DuplicatePolicy::SKIP);
+    {
+        LOG_DURATION("Add 100000 documents, skip duplicates"s);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            search_server.AddDocument(static_cast<int>(i), document_text(i), DocumentStatus::ACTUAL, { 1 });
+        }
+    }
+    assert(std::vector<int>(search_server.begin(), search_server.end())
+        == std::vector<int>(sweep_server.begin(), sweep_server.end()));
+
+    std::cout << std::endl;
+    std::cout << "----------- Duplicate Policy testing complete -----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void BatchMatchDocumentsTest() {
+    std::cout << "-------- Batch MatchDocuments testing in progress -------" << std::endl << std::endl;
+
+    mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(static_cast<int>(i * 2), documents[i], static_cast<DocumentStatus>(i % 4), { 1, 2, 3 });
+    }
+    search_server.SetPositionalIndex(true);
+    search_server.SetFuzzySearch(1);
+
+    auto expect_same = [&search_server](const std::string& query, const std::vector<DocumentMatch>& matches, const std::vector<int>& ids) {
+        assert(matches.size() == ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            const auto [words, status] = search_server.MatchDocument(query, ids[i]);
+            assert(matches[i].document_id == ids[i]);
+            assert(matches[i].words == words);
+            assert(matches[i].status == status);
+        }
+    };
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 20; ++i) {
+        queries.push_back(GenerateQueryWMinus(generator, dictionary, 10, 0.1));
+    }
+    queries.push_back(dictionary[10] + "* -"s + dictionary[20]);
+    queries.push_back("\""s + dictionary[30] + " "s + dictionary[40] + "\"~5 "s + dictionary[50]);
+    queries.push_back(dictionary[60] + "q"s);
+
+    const std::vector<int> all_ids(search_server.begin(), search_server.end());
+    // id    
+    std::vector<int> some_ids = { 18, 4, 19'998, 4, 0, 7'000 };
+    for (const std::string& query : queries) {
+        expect_same(query, search_server.MatchDocuments(query), all_ids);
+        expect_same(query, search_server.MatchDocuments(std::execution::par, query), all_ids);
+        expect_same(query, search_server.MatchDocuments(query, some_ids), some_ids);
+        expect_same(query, search_server.MatchDocuments(std::execution::par, query, some_ids), some_ids);
+    }
+
+    try {
+        search_server.MatchDocuments(queries[0], { 0, 1 });
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+
+    //     GetDocumentId  MatchDocument
+    {
+        LOG_DURATION("MatchDocument for each of 10000 documents"s);
+        for (int index = 0; index < static_cast<int>(search_server.GetDocumentCount()); ++index) {
+            search_server.MatchDocument(queries[0], search_server.GetDocumentId(index));
+        }
+    }
+    {
+        LOG_DURATION("MatchDocuments, 10000 documents"s);
+        search_server.MatchDocuments(queries[0]);
+    }
+    {
+        LOG_DURATION("MatchDocuments par, 10000 documents"s);
+        search_server.MatchDocuments(std::execution::par, queries[0]);
+    }
+
+    std::cout << std::endl;
+    std::cout << "--------- Batch MatchDocuments testing complete ---------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void AutoExecutionTest() {
+    std::cout << "---------- Auto Execution testing in progress -----------" << std::endl << std::endl;
+
+    {
+        //   -     
+        assert(ChooseExecution({ 3, 1'000, 500 }, AutoExecution{ 64 }).mode == ExecutionMode::SEQUENTIAL);
+        assert(ChooseExecution({ 3, 1'000'000, 500'000 }, AutoExecution{ 1 }).mode == ExecutionMode::SEQUENTIAL);
+
+        //      -  
+        const ExecutionPlan by_terms = ChooseExecution({ 40, 1'000'000, 50'000 }, AutoExecution{ 8 });
+        assert(by_terms.mode == ExecutionMode::TERM_PARALLEL && by_terms.thread_count == 8);
+
+        //      -  
+        assert(ChooseExecution({ 2, 1'000'000, 900'000 }, AutoExecution{ 8 }).mode == ExecutionMode::DOCUMENT_PARALLEL);
+        assert(ChooseExecution({ 40, 1'000'000, 600'000 }, AutoExecution{ 8 }).mode == ExecutionMode::DOCUMENT_PARALLEL);
+
+        //   ,   
+        const ExecutionPlan small = ChooseExecution({ 2, 40'000, 20'000 }, AutoExecution{ 64 });
+        assert(small.mode == ExecutionMode::DOCUMENT_PARALLEL && small.thread_count == 2);
+    }
+
+    //   -   
+    mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 20, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 30'000, 70);
+
+    SearchServer search_server(""s);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(static_cast<int>(i * 3), documents[i], static_cast<DocumentStatus>(i % 4),
+            { static_cast<int>(i % 21) - 10 });
+    }
+
+    auto expect_same = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        assert(lhs.size() == rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            assert(lhs[i].id == rhs[i].id);
+            assert(lhs[i].rating == rhs[i].rating);
+            assert(std::abs(lhs[i].relevance - rhs[i].relevance) < 1e-12);
+        }
+    };
+
+    const std::vector<std::string> queries = {
+        dictionary[1],
+        dictionary[2] + " "s + dictionary[3],
+        dictionary[4] + " "s + dictionary[5] + " -"s + dictionary[6],
+        GenerateQueryWMinus(generator, dictionary, 12, 0.2),
+        GenerateQueryWMinus(generator, dictionary, 20),
+    };
+    // 1 - , 2 -     , 8  64 -  
+    for (size_t max_threads : { 1, 2, 8, 64 }) {
+        const AutoExecution policy{ max_threads };
+        for (const std::string& query : queries) {
+            expect_same(search_server.FindTopDocuments(policy, query), search_server.FindTopDocuments(query));
+            expect_same(search_server.FindTopDocuments(policy, query, DocumentStatus::BANNED),
+                search_server.FindTopDocuments(query, DocumentStatus::BANNED));
+
+            const auto even_ids = [](int document_id, DocumentStatus, int) { return document_id % 2 == 0; };
+            expect_same(search_server.FindTopDocuments(policy, query, even_ids),
+                search_server.FindTopDocuments(query, even_ids));
+            expect_same(search_server.FindTopDocuments(policy, query, StatusIs(DocumentStatus::ACTUAL) && RatingRange(-3, 5)),
+                search_server.FindTopDocuments(query, StatusIs(DocumentStatus::ACTUAL) && RatingRange(-3, 5)));
+
+            const DocumentsPage page = search_server.FindDocumentsPage(policy, query, DocumentStatus::IRRELEVANT, 10, 20);
+            const DocumentsPage expected_page = search_server.FindDocumentsPage(std::execution::seq, query, DocumentStatus::IRRELEVANT, 10, 20);
+            assert(page.total_count == expected_page.total_count);
+            expect_same(page.documents, expected_page.documents);
+
+            const auto matches = search_server.MatchDocuments(policy, query);
+            const auto expected_matches = search_server.MatchDocuments(query);
+            assert(matches.size() == expected_matches.size());
+            for (size_t i = 0; i < matches.size(); ++i) {
+                assert(matches[i].words == expected_matches[i].words);
+            }
+        }
+    }
+
+    const auto bench_queries = GenerateQueries(generator, dictionary, 50, 4);
+    FTest("seq"sv, search_server, bench_queries, std::execution::seq);
+    FTest("par"sv, search_server, bench_queries, std::execution::par);
+    FTest("auto"sv, search_server, bench_queries, auto_execution);
+
+    std::cout << std::endl;
+    std::cout << "----------- Auto Execution testing complete -------------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
+
+void PreparedQueryTest() {
+    std::cout << "---------- Prepared Queries testing in progress ---------" << std::endl << std::endl;
+
+    mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(static_cast<int>(i * 2), documents[i], static_cast<DocumentStatus>(i % 4),
+            { static_cast<int>(i % 21) - 10 });
+    }
+    search_server.SetPositionalIndex(true);
+    search_server.SetFuzzySearch(1);
+
+    auto expect_same = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        assert(lhs.size() == rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            assert(lhs[i].id == rhs[i].id);
+            assert(lhs[i].rating == rhs[i].rating);
+            assert(std::abs(lhs[i].relevance - rhs[i].relevance) < 1e-12);
+        }
+    };
+
+    auto check_query = [&search_server, &expect_same](const std::string& raw_query, const SearchServer::PreparedQuery& query) {
+        const auto even_ids = [](int document_id, DocumentStatus, int) { return document_id % 4 == 0; };
+        expect_same(search_server.FindTopDocuments(query), search_server.FindTopDocuments(raw_query));
+        expect_same(search_server.FindTopDocuments(std::execution::par, query, DocumentStatus::BANNED),
+            search_server.FindTopDocuments(raw_query, DocumentStatus::BANNED));
+        expect_same(search_server.FindTopDocuments(query, even_ids), search_server.FindTopDocuments(raw_query, even_ids));
+        expect_same(search_server.FindTopDocuments(auto_execution, query), search_server.FindTopDocuments(raw_query));
+
+        const std::vector<int> some_ids = { 18, 4, 19'998, 2, 7'000 };
+        const auto matches = search_server.MatchDocuments(query, some_ids);
+        const auto par_matches = search_server.MatchDocuments(std::execution::par, query, some_ids);
+        for (size_t i = 0; i < some_ids.size(); ++i) {
+            const auto [words, status] = search_server.MatchDocument(raw_query, some_ids[i]);
+            assert(search_server.MatchDocument(query, some_ids[i]) == std::make_tuple(words, status));
+            assert(matches[i].words == words && par_matches[i].words == words);
+        }
+    };
+
+    std::vector<std::string> raw_queries;
+    for (int i = 0; i < 20; ++i) {
+        raw_queries.push_back(GenerateQueryWMinus(generator, dictionary, 10, 0.1));
+    }
+    raw_queries.push_back(dictionary[10] + "* -"s + dictionary[20]);
+    raw_queries.push_back("\""s + dictionary[30] + " "s + dictionary[40] + "\"~5 "s + dictionary[50]);
+    raw_queries.push_back(dictionary[60] + "q"s);
+    raw_queries.push_back("unknownword -otherunknown "s + dictionary[70]);
+
+    std::vector<SearchServer::PreparedQuery> queries;
+    for (const std::string& raw_query : raw_queries) {
+        queries.push_back(search_server.Prepare(raw_query));
+        assert(queries.back().GetText() == raw_query);
+        assert(search_server.IsCurrent(queries.back()));
+    }
+    for (size_t i = 0; i < queries.size(); ++i) {
+        check_query(raw_queries[i], queries[i]);
+    }
+
+    const auto processed = ProcessQueries(search_server, queries);
+    const auto expected_processed = ProcessQueries(search_server, raw_queries);
+    for (size_t i = 0; i < processed.size(); ++i) {
+        expect_same(processed[i], expected_processed[i]);
+    }
+
+    try {
+        search_server.Prepare("cat --dog"s);
+        assert(false);
+    }
+    catch (const std::invalid_argument&) {
+    }
+
+    //  :  ,   - , Refresh  
+    search_server.RemoveDocument(0);
+    search_server.AddDocument(100'000, dictionary[70] + " "s + dictionary[71], DocumentStatus::ACTUAL, { 5 });
+    search_server.SetScoring(Bm25Scoring{});
+    for (size_t i = 0; i < queries.size(); ++i) {
+        assert(!search_server.IsCurrent(queries[i]));
+        check_query(raw_queries[i], queries[i]);
+        const uint64_t generation = queries[i].GetGeneration();
+        search_server.Refresh(queries[i]);
+        assert(search_server.IsCurrent(queries[i]) && queries[i].GetGeneration() != generation);
+        check_query(raw_queries[i], queries[i]);
+    }
+
+    //      
+    SearchServer other_server(""s);
+    assert(!other_server.IsCurrent(queries[0]));
+
+    // ,        ,     :
+    //       
+    {
+        std::optional<SearchServer> replaced_server;
+        replaced_server.emplace(""s);
+        replaced_server->AddDocument(1, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+        const SearchServer::PreparedQuery query = replaced_server->Prepare("cat"s);
+        const SearchServer* address = &*replaced_server;
+
+        replaced_server.emplace(""s);
+        replaced_server->AddDocument(2, "cat and dog"s, DocumentStatus::ACTUAL, { 2 });
+        assert(&*replaced_server == address);
+        assert(!replaced_server->IsCurrent(query));
+        const auto found = replaced_server->FindTopDocuments(query);
+        assert(found.size() == 1 && found[0].id == 2);
+
+        const SearchServer fresh_server(""s);
+        assert(fresh_server.GetGeneration() != replaced_server->GetGeneration());
+    }
+
+    //      -    
+    std::vector<std::string> bench_queries = GenerateQueries(generator, dictionary, 1'000, 3);
+    for (size_t i = 0; i < bench_queries.size(); ++i) {
+        bench_queries[i] += " "s + dictionary[i % dictionary.size()] + "q "s + dictionary[(i * 7) % dictionary.size()].substr(0, 3) + "*"s;
+    }
+    std::vector<SearchServer::PreparedQuery> prepared_bench_queries;
+    for (const std::string& raw_query : bench_queries) {
+        prepared_bench_queries.push_back(search_server.Prepare(raw_query));
+    }
+    {
+        LOG_DURATION("1000 raw queries"s);
+        for (const std::string& raw_query : bench_queries) {
+            search_server.FindTopDocuments(raw_query);
+        }
+    }
+    {
+        LOG_DURATION("1000 prepared queries"s);
+        for (const SearchServer::PreparedQuery& query : prepared_bench_queries) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+
+    std::cout << std::endl;
+    std::cout << "----------- Prepared Queries testing complete -----------" << std::endl;
+    std::cout << "-------------------------- Done -------------------------" << std::endl << std::endl << std::endl;
+}
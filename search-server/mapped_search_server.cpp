@@ -0,0 +1,280 @@
+#include "mapped_search_server.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ===================== MappedFile =====================
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Can't open index file: " + path);
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_, &file_size);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0) {
+        CloseHandle(file_);
+        throw std::runtime_error("Index file is empty: " + path);
+    }
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw std::runtime_error("Can't map index file: " + path);
+    }
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("Can't map index file: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open index file: " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Index file is empty: " + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    // отображение держит файл само, дескриптор больше не нужен
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Can't map index file: " + path);
+    }
+    data_ = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<char*>(data_), size_);
+}
+
+#endif
+
+// ===================== MappedSearchServer =====================
+
+MappedSearchServer::MappedSearchServer(const std::string& path)
+    : file_(path) {
+
+    const std::string_view data = file_.GetData();
+
+    IndexFileHeader header{};
+    if (data.size() < sizeof(header)) {
+        throw std::runtime_error("Index file is truncated");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("File is not an index snapshot");
+    }
+    if (header.version != INDEX_VERSION) {
+        throw std::runtime_error("Unsupported index snapshot version " + std::to_string(header.version));
+    }
+    if (header.file_size != data.size()
+        || data.size() < sizeof(header) + sizeof(IndexSectionEntry) * header.section_count) {
+        throw std::runtime_error("Index file is truncated");
+    }
+
+    sections_ = reinterpret_cast<const IndexSectionEntry*>(data.data() + sizeof(header));
+    section_count_ = header.section_count;
+    for (size_t i = 0; i < section_count_; ++i) {
+        if (sections_[i].offset > data.size() || sections_[i].size > data.size() - sections_[i].offset
+            || sections_[i].offset % INDEX_ALIGNMENT != 0) {
+            throw std::runtime_error("Index section is out of file bounds");
+        }
+    }
+
+    const std::string_view documents = GetSection(IndexSectionKind::DOCUMENTS);
+    documents_ = reinterpret_cast<const IndexDocumentRecord*>(documents.data());
+    document_count_ = documents.size() / sizeof(IndexDocumentRecord);
+
+    const std::string_view terms = GetSection(IndexSectionKind::TERMS);
+    terms_ = reinterpret_cast<const IndexTermRecord*>(terms.data());
+    term_count_ = terms.size() / sizeof(IndexTermRecord);
+
+    const std::string_view postings = GetSection(IndexSectionKind::POSTINGS);
+    postings_ = reinterpret_cast<const IndexPostingRecord*>(postings.data());
+    const size_t posting_count = postings.size() / sizeof(IndexPostingRecord);
+
+    texts_ = GetSection(IndexSectionKind::TEXTS);
+
+    // Контрольные суммы при открытии не считаются (VerifyChecksums), но записи словаря и таблицы
+    // документов проверяются: дальше их поля служат смещениями в отображение без проверок.
+    // Постинги не читаются - их документ ищется при запросе (FindDocument), это не дороже самого запроса
+    auto check = [](bool condition) {
+        if (!condition) {
+            throw std::runtime_error("Index file is corrupted");
+        }
+    };
+    for (size_t i = 0; i < document_count_; ++i) {
+        const IndexDocumentRecord& document = documents_[i];
+        check(document.status >= 0 && document.status <= static_cast<int32_t>(DocumentStatus::REMOVED));
+        check(IsIndexRangeInside(document.text_offset, document.text_size, texts_.size()));
+    }
+    for (size_t i = 0; i < term_count_; ++i) {
+        const IndexTermRecord& term = terms_[i];
+        check(IsIndexRangeInside(term.text_offset, term.length, texts_.size()));
+        check(term.postings_count > 0 && IsIndexRangeInside(term.postings_offset, term.postings_count, posting_count));
+    }
+
+    // стоп-слов немного, их разбираем и строим по ним фильтр
+    VirturlStringSet stop_words_set;
+    std::string_view stop_words = GetSection(IndexSectionKind::STOP_WORDS);
+    uint64_t count = 0;
+    check(stop_words.size() >= sizeof(count));
+    std::memcpy(&count, stop_words.data(), sizeof(count));
+    stop_words.remove_prefix(sizeof(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t length = 0;
+        check(stop_words.size() >= sizeof(length));
+        std::memcpy(&length, stop_words.data(), sizeof(length));
+        stop_words.remove_prefix(sizeof(length));
+        check(length <= stop_words.size());
+        stop_words_set.emplace(stop_words.substr(0, length));
+        stop_words.remove_prefix(length);
+    }
+    stop_words_filter_ = StopWordsFilter(stop_words_set);
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocuments(raw_query, [status](int, DocumentStatus document_status, int) {
+        return document_status == status;
+        });
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(std::string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+MappedSearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+
+    const IndexDocumentRecord* document = FindDocument(document_id);
+    if (document == nullptr) {
+        throw std::out_of_range("Document id is not found");
+    }
+    const DocumentStatus status = static_cast<DocumentStatus>(document->status);
+
+    const Query query = ParseQuery(raw_query);
+
+    for (const IndexTermRecord* term : query.minus_terms) {
+        if (HasPosting(*term, document_id)) {
+            return { std::vector<std::string_view>{}, status };
+        }
+    }
+
+    std::vector<std::string_view> matched_words;
+    for (const IndexTermRecord* term : query.plus_terms) {
+        if (HasPosting(*term, document_id)) {
+            matched_words.push_back(GetTermWord(*term));
+        }
+    }
+    return { matched_words, status };
+}
+
+bool MappedSearchServer::VerifyChecksums() const {
+    const std::string_view data = file_.GetData();
+    return std::all_of(sections_, sections_ + section_count_, [&data](const IndexSectionEntry& entry) {
+        return ComputeIndexChecksum(data.substr(entry.offset, entry.size)) == entry.checksum;
+        });
+}
+
+std::string_view MappedSearchServer::GetSection(IndexSectionKind kind) const {
+    for (size_t i = 0; i < section_count_; ++i) {
+        if (sections_[i].kind == kind) {
+            return file_.GetData().substr(sections_[i].offset, sections_[i].size);
+        }
+    }
+    throw std::runtime_error("Index section is missing");
+}
+
+const IndexTermRecord* MappedSearchServer::FindTerm(std::string_view word) const {
+    const IndexTermRecord* end = terms_ + term_count_;
+    const IndexTermRecord* term = std::lower_bound(terms_, end, word,
+        [this](const IndexTermRecord& lhs, std::string_view rhs) { return GetTermWord(lhs) < rhs; });
+    if (term == end || GetTermWord(*term) != word) {
+        return nullptr;
+    }
+    return term;
+}
+
+const IndexDocumentRecord* MappedSearchServer::FindDocument(int document_id) const {
+    const IndexDocumentRecord* end = documents_ + document_count_;
+    const IndexDocumentRecord* document = std::lower_bound(documents_, end, document_id,
+        [](const IndexDocumentRecord& lhs, int id) { return lhs.document_id < id; });
+    if (document == end || document->document_id != document_id) {
+        return nullptr;
+    }
+    return document;
+}
+
+const IndexDocumentRecord& MappedSearchServer::GetPostingDocument(const IndexPostingRecord& posting) const {
+    const IndexDocumentRecord* document = FindDocument(posting.document_id);
+    if (document == nullptr) {
+        throw std::runtime_error("Index posting refers to a missing document");
+    }
+    return *document;
+}
+
+bool MappedSearchServer::HasPosting(const IndexTermRecord& term, int document_id) const {
+    const IndexPostingRecord* first = postings_ + term.postings_offset;
+    const IndexPostingRecord* last = first + term.postings_count;
+    const IndexPostingRecord* posting = std::lower_bound(first, last, document_id,
+        [](const IndexPostingRecord& lhs, int id) { return lhs.document_id < id; });
+    return posting != last && posting->document_id == document_id;
+}
+
+MappedSearchServer::Query MappedSearchServer::ParseQuery(std::string_view text) const {
+    Query result;
+    for (std::string_view word : SplitIntoWords(text)) {
+        bool is_minus = false;
+        if (!word.empty() && word[0] == '-') {
+            is_minus = true;
+            word.remove_prefix(1);
+        }
+        if (word.empty() || word[0] == '-'
+            || std::any_of(word.begin(), word.end(), [](char c) { return c >= '\0' && c < ' '; })) {
+            std::string string_word(word);
+            throw std::invalid_argument("Query word {\"" + string_word + "\"} is invalid");
+        }
+        if (stop_words_filter_.Contains(word)) {
+            continue;
+        }
+        // слов, которых нет в словаре, не ищем дальше
+        const IndexTermRecord* term = FindTerm(word);
+        if (term != nullptr) {
+            (is_minus ? result.minus_terms : result.plus_terms).push_back(term);
+        }
+    }
+
+    for (auto* terms : { &result.plus_terms, &result.minus_terms }) {
+        std::sort(terms->begin(), terms->end());
+        terms->erase(std::unique(terms->begin(), terms->end()), terms->end());
+    }
+    return result;
+}
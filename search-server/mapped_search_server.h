@@ -0,0 +1,138 @@
+#pragma once
+#include <execution>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "document.h"
+#include "index_format.h"
+#include "search_server.h"
+#include "stop_words_filter.h"
+#include "string_processing.h"
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    std::string_view GetData() const {
+        return { data_, size_ };
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+// Поисковый сервер только для чтения поверх снимка индекса (SearchServer::Save).
+// Файл отображается в память, словарь, постинги и таблица документов читаются
+// прямо из отображения без десериализации. Несколько процессов, открывших один файл,
+// делят одну физическую копию индекса через кэш страниц.
+class MappedSearchServer {
+public:
+    explicit MappedSearchServer(const std::string& path);
+
+    size_t GetDocumentCount() const {
+        return document_count_;
+    }
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    // найденные слова указывают в отображённый файл и живут, пока жив сервер
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+        MatchDocument(std::string_view raw_query, int document_id) const;
+
+    // полная проверка контрольных сумм, читает весь файл
+    bool VerifyChecksums() const;
+
+private:
+    struct Query {
+        std::vector<const IndexTermRecord*> plus_terms;
+        std::vector<const IndexTermRecord*> minus_terms;
+    };
+
+    MappedFile file_;
+    StopWordsFilter stop_words_filter_;
+
+    const IndexSectionEntry* sections_ = nullptr;
+    size_t section_count_ = 0;
+
+    const IndexDocumentRecord* documents_ = nullptr;
+    size_t document_count_ = 0;
+    const IndexTermRecord* terms_ = nullptr;
+    size_t term_count_ = 0;
+    const IndexPostingRecord* postings_ = nullptr;
+    std::string_view texts_;
+
+    std::string_view GetSection(IndexSectionKind kind) const;
+
+    std::string_view GetTermWord(const IndexTermRecord& term) const {
+        return texts_.substr(term.text_offset, term.length);
+    }
+
+    // двоичный поиск по словарю, nullptr если слова нет
+    const IndexTermRecord* FindTerm(std::string_view word) const;
+
+    // двоичный поиск по таблице документов, nullptr если документа нет
+    const IndexDocumentRecord* FindDocument(int document_id) const;
+
+    // документ из постинга, std::runtime_error если его нет в таблице - файл повреждён
+    const IndexDocumentRecord& GetPostingDocument(const IndexPostingRecord& posting) const;
+
+    bool HasPosting(const IndexTermRecord& term, int document_id) const;
+
+    Query ParseQuery(std::string_view text) const;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> MappedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const {
+
+    const Query query = ParseQuery(raw_query);
+
+    std::map<int, double> document_to_relevance;
+    for (const IndexTermRecord* term : query.plus_terms) {
+        const double inverse_document_freq = std::log(document_count_ * 1.0 / term->postings_count);
+        const IndexPostingRecord* first = postings_ + term->postings_offset;
+        for (const IndexPostingRecord* posting = first; posting != first + term->postings_count; ++posting) {
+            const IndexDocumentRecord& document = GetPostingDocument(*posting);
+            if (document_predicate(document.document_id, static_cast<DocumentStatus>(document.status), document.rating)) {
+                document_to_relevance[posting->document_id] += posting->term_freq * inverse_document_freq;
+            }
+        }
+    }
+
+    for (const IndexTermRecord* term : query.minus_terms) {
+        const IndexPostingRecord* first = postings_ + term->postings_offset;
+        for (const IndexPostingRecord* posting = first; posting != first + term->postings_count; ++posting) {
+            document_to_relevance.erase(posting->document_id);
+        }
+    }
+
+    // в document_to_relevance только документы, найденные в таблице по постингам
+    std::vector<Document> matched_documents;
+    for (const auto [document_id, relevance] : document_to_relevance) {
+        matched_documents.push_back({ document_id, relevance, FindDocument(document_id)->rating });
+    }
+
+    const auto top_end = SelectDocumentsRange(std::execution::seq, matched_documents.begin(), matched_documents.end(),
+        0, MAX_RESULT_DOCUMENT_COUNT);
+    matched_documents.erase(top_end, matched_documents.end());
+
+    return matched_documents;
+}
@@ -0,0 +1,192 @@
+#include "near_duplicates.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+    // финальное перемешивание splitmix64
+    uint64_t Mix(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    uint32_t HashWord(std::string_view word) {
+        const uint64_t hash = Mix(std::hash<std::string_view>{}(word));
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+    // семейство перестановок 32-битных хешей x -> ((x ^ xor) * multiplier) ^ сдвиг,
+    // multiplier нечётный, поэтому каждая функция - перестановка
+    struct HashFamily {
+        std::vector<uint32_t> xors;
+        std::vector<uint32_t> multipliers;
+
+        explicit HashFamily(size_t size)
+            : xors(size)
+            , multipliers(size) {
+            for (size_t i = 0; i < size; ++i) {
+                const uint64_t seed = Mix(0x9E3779B97F4A7C15ull * (i + 1));
+                xors[i] = static_cast<uint32_t>(seed);
+                multipliers[i] = static_cast<uint32_t>(seed >> 32) | 1u;
+            }
+        }
+    };
+
+    // плоский цикл без ветвлений по всем функциям семейства, компилятор его векторизует
+    void UpdateSignature(uint32_t word_hash, const uint32_t* xors, const uint32_t* multipliers, uint32_t* signature, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t value = (word_hash ^ xors[i]) * multipliers[i];
+            value ^= value >> 16;
+            signature[i] = std::min(signature[i], value);
+        }
+    }
+
+    double ComputeJaccard(const std::map<std::string_view, double>& lhs, const std::map<std::string_view, double>& rhs) {
+        size_t intersection = 0;
+        auto lhs_it = lhs.begin();
+        auto rhs_it = rhs.begin();
+        while (lhs_it != lhs.end() && rhs_it != rhs.end()) {
+            if (lhs_it->first < rhs_it->first) {
+                ++lhs_it;
+            }
+            else if (rhs_it->first < lhs_it->first) {
+                ++rhs_it;
+            }
+            else {
+                ++intersection;
+                ++lhs_it;
+                ++rhs_it;
+            }
+        }
+        return static_cast<double>(intersection) / static_cast<double>(lhs.size() + rhs.size() - intersection);
+    }
+
+} // namespace
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const SearchServer& search_server, const NearDuplicateOptions& options) {
+    using namespace std::literals::string_literals;
+    if (!(options.jaccard_threshold > 0.0 && options.jaccard_threshold <= 1.0)
+        || options.band_count == 0 || options.rows_per_band == 0) {
+        throw std::invalid_argument("Invalid near duplicate options"s);
+    }
+
+    // id непустых документов по возрастанию
+    std::vector<int> document_ids;
+    for (int document_id : search_server) {
+        if (!search_server.GetWordFrequencies(document_id).empty()) {
+            document_ids.push_back(document_id);
+        }
+    }
+
+    const size_t document_count = document_ids.size();
+    const size_t signature_size = options.band_count * options.rows_per_band;
+    const HashFamily family(signature_size);
+    std::vector<uint32_t> signatures(document_count * signature_size);
+    // ключ каждой полосы подписи
+    std::vector<uint64_t> band_keys(document_count * options.band_count);
+
+    std::vector<size_t> indexes(document_count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(),
+        [&](size_t index) {
+            uint32_t* signature = signatures.data() + index * signature_size;
+            std::fill(signature, signature + signature_size, std::numeric_limits<uint32_t>::max());
+            for (const auto& [word, _] : search_server.GetWordFrequencies(document_ids[index])) {
+                UpdateSignature(HashWord(word), family.xors.data(), family.multipliers.data(), signature, signature_size);
+            }
+            for (size_t band = 0; band < options.band_count; ++band) {
+                uint64_t key = 0;
+                for (size_t row = 0; row < options.rows_per_band; ++row) {
+                    key = Mix(key ^ signature[band * options.rows_per_band + row]);
+                }
+                band_keys[index * options.band_count + band] = key;
+            }
+        });
+
+    // номер корзины каждой полосы каждого документа: документы с равным ключом полосы попадают в одну корзину,
+    // полосы упорядочиваются параллельно
+    std::vector<uint32_t> bucket_ids(document_count * options.band_count);
+    std::vector<size_t> bands(options.band_count);
+    std::iota(bands.begin(), bands.end(), 0);
+    std::for_each(std::execution::par, bands.begin(), bands.end(),
+        [&](size_t band) {
+            std::vector<std::pair<uint64_t, uint32_t>> entries(document_count);
+            for (uint32_t index = 0; index < document_count; ++index) {
+                entries[index] = { band_keys[index * options.band_count + band], index };
+            }
+            std::sort(entries.begin(), entries.end());
+            uint32_t bucket = 0;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (i > 0 && entries[i].first != entries[i - 1].first) {
+                    ++bucket;
+                }
+                bucket_ids[entries[i].second * options.band_count + band] = bucket;
+            }
+        });
+
+    // в корзинах списками хранятся только оставленные документы, поэтому группа одинаковых документов
+    // сверяется с одним оригиналом, а не попарно.
+    // heads - первый документ корзины по номеру band * document_count + корзина,
+    // next - следующий документ той же корзины по номеру index * band_count + band
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> heads(document_count * options.band_count, NONE);
+    std::vector<uint32_t> next(document_count * options.band_count, NONE);
+    // номер документа, для которого кандидат уже сверялся
+    std::vector<uint32_t> checked_for(document_count, NONE);
+    std::vector<NearDuplicatePair> result;
+
+    for (uint32_t index = 0; index < document_count; ++index) {
+        const auto& word_freqs = search_server.GetWordFrequencies(document_ids[index]);
+        const uint32_t* buckets = bucket_ids.data() + static_cast<size_t>(index) * options.band_count;
+
+        uint32_t original = NONE;
+        double similarity = 0.0;
+        for (size_t band = 0; band < options.band_count; ++band) {
+            for (uint32_t candidate = heads[band * document_count + buckets[band]]; candidate != NONE;
+                candidate = next[static_cast<size_t>(candidate) * options.band_count + band]) {
+                // нужен оригинал с наименьшим id
+                if (candidate >= original || checked_for[candidate] == index) {
+                    continue;
+                }
+                checked_for[candidate] = index;
+                const double jaccard = ComputeJaccard(word_freqs, search_server.GetWordFrequencies(document_ids[candidate]));
+                if (jaccard >= options.jaccard_threshold) {
+                    original = candidate;
+                    similarity = jaccard;
+                }
+            }
+        }
+
+        if (original != NONE) {
+            result.push_back({ document_ids[original], document_ids[index], similarity });
+            continue;
+        }
+        for (size_t band = 0; band < options.band_count; ++band) {
+            uint32_t& head = heads[band * document_count + buckets[band]];
+            next[static_cast<size_t>(index) * options.band_count + band] = head;
+            head = index;
+        }
+    }
+    return result;
+}
+
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options) {
+    std::vector<int> duplicates;
+    for (const NearDuplicatePair& pair : FindNearDuplicates(search_server, options)) {
+        std::cout << "Found near duplicate document id " << pair.duplicate_id
+            << " of document id " << pair.original_id << std::endl;
+        duplicates.push_back(pair.duplicate_id);
+    }
+    search_server.RemoveDocuments(duplicates);
+}
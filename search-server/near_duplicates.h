@@ -0,0 +1,29 @@
+#pragma once
+#include "search_server.h"
+
+#include <vector>
+
+// Поиск почти-дубликатов: документов, у которых мера Жаккара множеств слов не меньше порога.
+// Каждому документу параллельно считается MinHash-подпись из band_count * rows_per_band минимумов,
+// подпись режется на полосы (LSH), документы с совпавшей хоть в одной полосе частью становятся кандидатами.
+// Кандидаты сверяются по точной мере Жаккара, поэтому ложных пар нет, а пропуск пары с мерой s
+// случается с вероятностью (1 - s^rows_per_band)^band_count.
+struct NearDuplicateOptions {
+    double jaccard_threshold = 0.8;
+    size_t band_count = 16;
+    size_t rows_per_band = 4;
+};
+
+struct NearDuplicatePair {
+    int original_id = 0;
+    int duplicate_id = 0;
+    double similarity = 0.0;    // точная мера Жаккара
+};
+
+// Документы просматриваются по возрастанию id, документ похожий на один из уже оставленных - дубликат,
+// в паре указан оставленный документ с наименьшим id. Документы без слов не рассматриваются.
+// Неверные параметры - исключение std::invalid_argument
+std::vector<NearDuplicatePair> FindNearDuplicates(const SearchServer& search_server, const NearDuplicateOptions& options = {});
+
+// выводит и удаляет найденные почти-дубликаты
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options = {});
@@ -1,6 +1,8 @@
 #pragma once
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <iterator>
 #include "document.h"
 
 
@@ -40,36 +42,150 @@ std::ostream& operator<<(std::ostream& out, const IteratorRange<Iterator>& range
 }
 
 
+// Страницы не хранятся, а вычисляются по номеру при обращении: O(1) памяти на любой объём выдачи.
+// Для итераторов произвольного доступа получение любой страницы тоже O(1)
 template <typename Iterator>
 class Paginator {
 public:
-    Paginator(Iterator begin, Iterator end, size_t page_size) {
-        assert(end >= begin);
-        assert(page_size > 0);
-        for (size_t left = distance(begin, end); left > 0;) {
-            const size_t current_page_size = std::min(page_size, left);
-            const Iterator current_page_end = next(begin, current_page_size);
-            pages_.push_back({ begin, current_page_end });
+    class PageIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = IteratorRange<Iterator>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = IteratorRange<Iterator>;
+
+        PageIterator() = default;
+
+        PageIterator(Iterator begin, size_t item_count, size_t page_size, size_t index)
+            : begin_(begin)
+            , item_count_(item_count)
+            , page_size_(page_size)
+            , index_(index) {
+        }
+
+        reference operator*() const {
+            return MakePage(begin_, item_count_, page_size_, index_);
+        }
+
+        reference operator[](difference_type n) const {
+            return *(*this + n);
+        }
+
+        PageIterator& operator++() {
+            ++index_;
+            return *this;
+        }
+
+        PageIterator operator++(int) {
+            PageIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        PageIterator& operator--() {
+            --index_;
+            return *this;
+        }
+
+        PageIterator operator--(int) {
+            PageIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        PageIterator& operator+=(difference_type n) {
+            index_ += n;
+            return *this;
+        }
+
+        PageIterator& operator-=(difference_type n) {
+            index_ -= n;
+            return *this;
+        }
+
+        friend PageIterator operator+(PageIterator it, difference_type n) {
+            return it += n;
+        }
+
+        friend PageIterator operator+(difference_type n, PageIterator it) {
+            return it += n;
+        }
 
-            left -= current_page_size;
-            begin = current_page_end;
+        friend PageIterator operator-(PageIterator it, difference_type n) {
+            return it -= n;
         }
+
+        friend difference_type operator-(const PageIterator& lhs, const PageIterator& rhs) {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const PageIterator& lhs, const PageIterator& rhs) {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const PageIterator& lhs, const PageIterator& rhs) {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const PageIterator& lhs, const PageIterator& rhs) {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const PageIterator& lhs, const PageIterator& rhs) {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const PageIterator& lhs, const PageIterator& rhs) {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const PageIterator& lhs, const PageIterator& rhs) {
+            return !(lhs < rhs);
+        }
+
+    private:
+        Iterator begin_{};
+        size_t item_count_ = 0;
+        size_t page_size_ = 1;
+        size_t index_ = 0;
+    };
+
+    Paginator(Iterator begin, Iterator end, size_t page_size)
+        : begin_(begin)
+        , item_count_(static_cast<size_t>(distance(begin, end)))
+        , page_size_(page_size) {
+        assert(page_size > 0);
     }
 
-    auto begin() const {
-        return pages_.begin();
+    PageIterator begin() const {
+        return { begin_, item_count_, page_size_, 0 };
     }
 
-    auto end() const {
-        return pages_.end();
+    PageIterator end() const {
+        return { begin_, item_count_, page_size_, size() };
     }
 
     size_t size() const {
-        return pages_.size();
+        return (item_count_ + page_size_ - 1) / page_size_;
     };
 
+    // страница по номеру, начиная с 0
+    IteratorRange<Iterator> operator[](size_t index) const {
+        assert(index < size());
+        return MakePage(begin_, item_count_, page_size_, index);
+    }
+
 private:
-    std::vector<IteratorRange<Iterator>> pages_;
+    Iterator begin_;
+    size_t item_count_;
+    size_t page_size_;
+
+    static IteratorRange<Iterator> MakePage(Iterator begin, size_t item_count, size_t page_size, size_t index) {
+        const size_t page_offset = index * page_size;
+        const Iterator page_begin = next(begin, page_offset);
+        return { page_begin, next(page_begin, std::min(page_size, item_count - page_offset)) };
+    }
 };
 
 
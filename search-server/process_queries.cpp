@@ -86,6 +86,15 @@ std::vector<std::vector<Document>> ProcessQueries(
 
 	return result;
 }
+std::vector<std::vector<Document>> ProcessQueries(
+	const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries) {
+
+	std::vector<std::vector<Document>> result(queries.size());
+	std::transform(std::execution::par, queries.begin(), queries.end(), result.begin(),
+		[&search_server](const SearchServer::PreparedQuery& query) {return search_server.FindTopDocuments(query); });
+
+	return result;
+}
 std::vector<Document> ProcessQueriesJoined(
 	const SearchServer& search_server, const std::vector<std::string>& queries) {
 	
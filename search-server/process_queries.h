@@ -7,4 +7,7 @@
 
 std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries);
 
-std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
\ No newline at end of file
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
+
+// то же для подготовленных запросов: разбор не повторяется, пока база не изменилась
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries);
\ No newline at end of file
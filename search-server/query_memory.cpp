@@ -0,0 +1,25 @@
+#include "query_memory.h"
+
+QueryMemory::ThreadArena::ThreadArena()
+    : resource(buffer, sizeof(buffer), std::pmr::new_delete_resource()) {
+}
+
+QueryMemory::ThreadArena& QueryMemory::GetThreadArena() {
+    thread_local ThreadArena arena;
+    return arena;
+}
+
+std::pmr::memory_resource* QueryMemory::GetResource() {
+    return &GetThreadArena().resource;
+}
+
+QueryMemory::Scope::Scope() {
+    ++GetThreadArena().depth;
+}
+
+QueryMemory::Scope::~Scope() {
+    ThreadArena& arena = GetThreadArena();
+    if (--arena.depth == 0) {
+        arena.resource.release();
+    }
+}
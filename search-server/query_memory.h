@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+// Память для временных объектов одного запроса.
+// У каждого потока свой монотонный буфер: выделения внутри запроса не идут
+// в общий аллокатор и не конкурируют между потоками, а освобождаются разом,
+// когда закрывается самая внешняя QueryMemory::Scope в этом потоке.
+class QueryMemory {
+public:
+    // ресурс текущего потока
+    static std::pmr::memory_resource* GetResource();
+
+    // область запроса, вложенные области не сбрасывают буфер
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    static const size_t INITIAL_BUFFER_SIZE = 16 * 1024;
+
+    struct ThreadArena {
+        ThreadArena();
+
+        alignas(std::max_align_t) std::byte buffer[INITIAL_BUFFER_SIZE];
+        std::pmr::monotonic_buffer_resource resource;
+        int depth = 0;
+    };
+
+    static ThreadArena& GetThreadArena();
+};
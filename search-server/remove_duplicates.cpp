@@ -1,36 +1,43 @@
 #include "remove_duplicates.h"
+#include "document_fingerprint.h"
+
+#include <algorithm>
+#include <execution>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
 
 void RemoveDuplicates(SearchServer& search_server) {
-    size_t total_documents = search_server.GetDocumentCount();
-    std::set<int> duplicats_ = {};
-    std::set<std::set<std::string_view>> check_ = {};
+    // настоящие id документов по возрастанию, они не обязаны идти подряд
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+
+    std::vector<DocumentFingerprint> fingerprints(document_ids.size());
+    std::transform(std::execution::par, document_ids.begin(), document_ids.end(), fingerprints.begin(),
+        [&search_server](int document_id) { return ComputeFingerprint(search_server.GetWordFrequencies(document_id)); });
 
-    for (int i = 1; i <= total_documents; i++) {
-        const auto& document_ = search_server.GetWordFrequencies(i);
-        if (document_.empty()) {
+    // первый документ с каждым отпечатком - оригинал, он же с наименьшим id
+    std::unordered_map<DocumentFingerprint, int, DocumentFingerprintHasher> originals;
+    originals.reserve(document_ids.size());
+    std::vector<int> duplicates;
+    for (size_t i = 0; i < document_ids.size(); ++i) {
+        const auto& word_freqs = search_server.GetWordFrequencies(document_ids[i]);
+        if (word_freqs.empty()) {
             continue;
         }
-        else {
-            auto document_words_ = WordsSetCreator(document_);
-            if (check_.count(document_words_)) {
-                duplicats_.insert(i);
-            }
-            else {
-                check_.insert(document_words_);
-            }
-        } 
-    }
-
-    for (auto duplicat : duplicats_) {
-        std::cout << "Found duplicate document id " << duplicat << std::endl;
-        search_server.RemoveDocument(duplicat);
+        const auto [it, inserted] = originals.emplace(fingerprints[i], document_ids[i]);
+        if (inserted) {
+            continue;
+        }
+        // совпадение отпечатков проверяется по самим словам
+        const auto& original_freqs = search_server.GetWordFrequencies(it->second);
+        if (std::equal(word_freqs.begin(), word_freqs.end(), original_freqs.begin(), original_freqs.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first == rhs.first; })) {
+            duplicates.push_back(document_ids[i]);
+        }
     }
-}
 
-std::set<std::string_view> WordsSetCreator(const std::map<std::string_view, double>& element) {
-    std::set<std::string_view> result = {};
-    for (const auto& e : element) {
-        result.insert(e.first);
+    for (int duplicate : duplicates) {
+        std::cout << "Found duplicate document id " << duplicate << std::endl;
     }
-    return result;
+    search_server.RemoveDocuments(duplicates);
 }
@@ -1,8 +1,6 @@
 #pragma once
 #include "search_server.h"
-#include <map>
-#include <set>
 
-void RemoveDuplicates(SearchServer& search_server);
-
-std::set<std::string_view> WordsSetCreator(const std::map<std::string_view, double>& element);
\ No newline at end of file
+// Удаляет документы с тем же множеством слов, что у документа с меньшим id.
+// Документы сравниваются по отпечаткам (document_fingerprint.h), отпечатки считаются параллельно
+void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
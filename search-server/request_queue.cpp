@@ -1,49 +1,44 @@
 #include "request_queue.h"
 
 RequestQueue::RequestQueue(const SearchServer& search_server)
-    : search_server_(search_server) {
+    : search_server_(search_server), requests_(min_in_day_) {
 }
 
 std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentStatus status) {
-    return AddFindRequest(raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-        });
+    return AddFindRequest(std::execution::seq, raw_query, status);
 }
 
 std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
     return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
 }
 
+size_t RequestQueue::GetQuerySize() const {
+    const int issued = request_counter_.load();
+    return static_cast<size_t>(issued < min_in_day_ ? issued : min_in_day_);
+}
+
 int RequestQueue::GetQueryNumber() const {
-    if (GetQuerySize() == 0) {
-        return query_start_number;
-    }
-    else {
-        auto last_element = requests_[GetQuerySize() - 1];
-        return last_element.request_numer_ + 1;
-    }
+    return request_counter_.load() + query_start_number;
 }
 
 int RequestQueue::GetNoResultRequests() const {
-    int result = 0;
-    for (const auto& element : requests_) {
-        if (element.no_result_) {
-            result++;
-        }
-    }
-    return result;
+    return no_result_count_.load();
 }
 
 std::pair<std::string, std::vector<Document>> RequestQueue::GetResultByRequestNumber(int request_number) const {
-    std::pair<std::string, std::vector<Document>> result = {};
-    for (const auto& req : requests_) {
-        if (req.request_numer_ == request_number) {
-            std::string request = req.query_;
-            std::vector<Document> request_result = req.result_;
-            result = { request, request_result };
-        }
+    const int last_number = request_counter_.load();
+    if (request_number < query_start_number || request_number > last_number
+        || request_number <= last_number - min_in_day_) {
+        return {};
     }
-    return result;
+
+    const Slot& slot = requests_[(request_number - query_start_number) % min_in_day_];
+    std::lock_guard guard(slot.mutex_);
+    if (slot.data_.request_numer_ != request_number) {
+        // запрос ещё записывается другим потоком или уже вытеснен из окна
+        return {};
+    }
+    return { slot.data_.query_, slot.data_.result_ };
 }
 
 void RequestQueue::PrintResultByHistoryNumber(int request_number) {
@@ -60,8 +55,73 @@ void RequestQueue::PrintResultByHistoryNumber(int request_number) {
 
 RequestQueue::QueryResult::QueryResult() = default;
 
-RequestQueue::QueryResult::QueryResult(int req_n, std::string query, bool res, std::vector<Document> vec_result)
-    : request_numer_(req_n), query_(query), no_result_(res), result_(vec_result) {
+RequestQueue::QueryResult::QueryResult(int req_n, std::string query, bool res, std::vector<Document> vec_result,
+    RequestTelemetry telemetry, Clock::time_point finished_at)
+    : request_numer_(req_n), query_(query), no_result_(res), result_(vec_result)
+    , telemetry_(telemetry), finished_at_(finished_at) {
+}
+
+void RequestQueue::AddRequestResult(const std::string& raw_query, const std::vector<Document>& result,
+    RequestTelemetry telemetry, Clock::time_point finished_at) {
+    const int request_number = request_counter_.fetch_add(1) + query_start_number;
+    const bool no_result = result.empty();
+
+    Slot& slot = requests_[(request_number - query_start_number) % min_in_day_];
+    std::lock_guard guard(slot.mutex_);
+
+    // более новый запрос уже занял ячейку - наш запрос выпал из окна
+    if (slot.data_.request_numer_ > request_number) {
+        return;
+    }
+    // вытесняем старый запрос из окна
+    if (slot.data_.request_numer_ != 0) {
+        if (slot.data_.no_result_) {
+            --no_result_count_;
+        }
+        latency_histogram_.Remove(slot.data_.telemetry_.latency);
+    }
+    slot.data_ = { request_number, raw_query, no_result, result, telemetry, finished_at };
+    if (no_result) {
+        ++no_result_count_;
+    }
+    latency_histogram_.Add(telemetry.latency);
 }
 
+std::optional<RequestTelemetry> RequestQueue::GetTelemetryByRequestNumber(int request_number) const {
+    const int last_number = request_counter_.load();
+    if (request_number < query_start_number || request_number > last_number
+        || request_number <= last_number - min_in_day_) {
+        return std::nullopt;
+    }
 
+    const Slot& slot = requests_[(request_number - query_start_number) % min_in_day_];
+    std::lock_guard guard(slot.mutex_);
+    if (slot.data_.request_numer_ != request_number) {
+        return std::nullopt;
+    }
+    return slot.data_.telemetry_;
+}
+
+WindowTelemetry RequestQueue::GetWindowTelemetry() const {
+    WindowTelemetry result;
+    result.request_count = latency_histogram_.GetCount();
+    result.p50 = latency_histogram_.GetPercentile(50.0);
+    result.p95 = latency_histogram_.GetPercentile(95.0);
+    result.p99 = latency_histogram_.GetPercentile(99.0);
+
+    // пропускная способность: запросы окна на интервал от самого старого до самого свежего
+    Clock::time_point oldest = Clock::time_point::max();
+    Clock::time_point newest = Clock::time_point::min();
+    for (const Slot& slot : requests_) {
+        std::lock_guard guard(slot.mutex_);
+        if (slot.data_.request_numer_ != 0) {
+            oldest = std::min(oldest, slot.data_.finished_at_);
+            newest = std::max(newest, slot.data_.finished_at_);
+        }
+    }
+    if (result.request_count > 1 && newest > oldest) {
+        const double seconds = std::chrono::duration<double>(newest - oldest).count();
+        result.throughput = (result.request_count - 1) / seconds;
+    }
+    return result;
+}
@@ -1,15 +1,47 @@
 #pragma once
-#include <stack>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <type_traits>
 #include <vector>
 #include <execution>
 #include "document.h"
 #include "search_server.h"
+#include "latency_histogram.h"
 
+// политика, с которой выполнялся запрос
+enum class QueryPolicy {
+    SEQUENCED,
+    PARALLEL,
+    AUTO,       // AutoExecution: ход выбирался по оценке стоимости запроса
+};
+
+// телеметрия одного запроса из истории
+struct RequestTelemetry {
+    std::chrono::microseconds latency{ 0 };   // время выполнения поиска
+    size_t matched_count = 0;                 // найдено документов до обрезки выдачи
+    QueryPolicy policy = QueryPolicy::SEQUENCED;
+};
+
+// сводная телеметрия по текущему окну запросов
+struct WindowTelemetry {
+    size_t request_count = 0;
+    std::chrono::microseconds p50{ 0 };
+    std::chrono::microseconds p95{ 0 };
+    std::chrono::microseconds p99{ 0 };
+    double throughput = 0.0;                  // запросов в секунду на интервале окна
+};
+
+// Очередь запросов хранит историю последних min_in_day_ запросов.
+// Потокобезопасна: AddFindRequest можно вызывать из нескольких потоков одновременно.
+// Каждый запрос получает номер из атомарного счётчика и пишется в кольцевой буфер
+// в ячейку (номер - 1) % min_in_day_, каждая ячейка защищена собственным мьютексом.
 class RequestQueue {
     const SearchServer& search_server_;
 public:
     explicit RequestQueue(const SearchServer& search_server);
-    
+
     template <typename DocumentPredicate>
     std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate);
 
@@ -27,11 +59,9 @@ public:
     template <typename ExecutionPolicy>
     std::vector<Document> AddFindRequest(const ExecutionPolicy& policy, const std::string& raw_query);
 
-    size_t GetQuerySize() const {
-        return requests_.size();
-    }
+    size_t GetQuerySize() const; // количество запросов в текущем окне
 
-    int GetQueryNumber() const;
+    int GetQueryNumber() const; // номер, который получит следующий запрос
 
     int GetNoResultRequests() const; // выдает количество безрезультативных запросов
 
@@ -39,80 +69,98 @@ public:
 
     void PrintResultByHistoryNumber(int request_number);
 
+    // телеметрия запроса по номеру, пустой optional если запроса нет в окне
+    std::optional<RequestTelemetry> GetTelemetryByRequestNumber(int request_number) const;
+
+    // перцентили задержек и пропускная способность по текущему окну
+    WindowTelemetry GetWindowTelemetry() const;
+
 private:
+    using Clock = std::chrono::steady_clock;
+
     struct QueryResult {
         QueryResult();
 
-        QueryResult(int req_n, std::string query, bool res, std::vector<Document> vec_result);
+        QueryResult(int req_n, std::string query, bool res, std::vector<Document> vec_result,
+            RequestTelemetry telemetry, Clock::time_point finished_at);
 
         //система хранит 1440 запроса в памяти
-        int request_numer_ = 0;              // хранит номер запроса 
+        int request_numer_ = 0;              // хранит номер запроса (0 - ячейка пуста)
         std::string query_;                  // строка запроса
         bool no_result_ = true;              // был ли результат
         std::vector<Document> result_ = {};  // результат запроса
+        RequestTelemetry telemetry_;         // задержка, объём выдачи, политика
+        Clock::time_point finished_at_;      // момент завершения запроса
     };
-    std::deque<QueryResult> requests_;
+
+    // ячейка кольцевого буфера
+    struct Slot {
+        QueryResult data_;
+        mutable std::mutex mutex_;
+    };
+
+    std::vector<Slot> requests_;
+    std::atomic<int> request_counter_ = 0;   // сколько номеров запросов выдано
+    std::atomic<int> no_result_count_ = 0;   // безрезультативные запросы в окне
+    LatencyHistogram latency_histogram_;     // задержки запросов в окне
     const static int query_start_number = 1;
     const static int min_in_day_ = 1440;
-};
 
-template <typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
+    // сохраняет результат запроса в истории, вызывается после выполнения поиска
+    void AddRequestResult(const std::string& raw_query, const std::vector<Document>& result,
+        RequestTelemetry telemetry, Clock::time_point finished_at);
 
-    std::vector<Document> result = search_server_.FindTopDocuments(std::execution::seq, raw_query, document_predicate);
+    // выполняет поиск и пишет его в историю; фильтр - предикат или DocumentStatus
+    template <typename ExecutionPolicy, typename DocumentFilter>
+    std::vector<Document> ExecuteFindRequest(const ExecutionPolicy& policy, const std::string& raw_query, DocumentFilter document_filter);
 
-    if (GetQuerySize() < min_in_day_) {
-        if (result.empty()) {
-            requests_.push_back({ GetQueryNumber(), raw_query, true, result });
+    template <typename ExecutionPolicy>
+    static QueryPolicy GetQueryPolicy(const ExecutionPolicy&) {
+        if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::parallel_policy>) {
+            return QueryPolicy::PARALLEL;
         }
-        else {
-            requests_.push_back({ GetQueryNumber(), raw_query, false, result });
-        }
-    }
-    else {
-        requests_.pop_front();
-        if (result.empty()) {
-            requests_.push_back({ GetQueryNumber(), raw_query, true, result });
+        else if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, AutoExecution>) {
+            return QueryPolicy::AUTO;
         }
         else {
-            requests_.push_back({ GetQueryNumber(), raw_query, false, result });
+            return QueryPolicy::SEQUENCED;
         }
     }
-    return result;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
+    return AddFindRequest(std::execution::seq, raw_query, document_predicate);
 }
 
 template <typename ExecutionPolicy, typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(const ExecutionPolicy& policy, 
+std::vector<Document> RequestQueue::AddFindRequest(const ExecutionPolicy& policy,
     const std::string& raw_query, DocumentPredicate document_predicate) {
-
-    std::vector<Document> result = search_server_.FindTopDocuments(policy, raw_query, document_predicate);
-
-    if (GetQuerySize() < min_in_day_) {
-        if (result.empty()) {
-            requests_.push_back({ GetQueryNumber(), raw_query, true, result });
-        }
-        else {
-            requests_.push_back({ GetQueryNumber(), raw_query, false, result });
-        }
-    }
-    else {
-        requests_.pop_front();
-        if (result.empty()) {
-            requests_.push_back({ GetQueryNumber(), raw_query, true, result });
-        }
-        else {
-            requests_.push_back({ GetQueryNumber(), raw_query, false, result });
-        }
-    }
-    return result;
+    return ExecuteFindRequest(policy, raw_query, document_predicate);
 }
 
 template <typename ExecutionPolicy>
-std::vector<Document> RequestQueue::AddFindRequest(const ExecutionPolicy& policy, 
+std::vector<Document> RequestQueue::AddFindRequest(const ExecutionPolicy& policy,
     const std::string& raw_query, DocumentStatus status) {
-    return AddFindRequest(policy, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-        });
+    // статус передаётся серверу как есть, чтобы сработал индекс по статусам
+    return ExecuteFindRequest(policy, raw_query, status);
+}
+
+template <typename ExecutionPolicy, typename DocumentFilter>
+std::vector<Document> RequestQueue::ExecuteFindRequest(const ExecutionPolicy& policy,
+    const std::string& raw_query, DocumentFilter document_filter) {
+
+    // поиск выполняется вне блокировок, история пишется уже по готовому результату
+    RequestTelemetry telemetry;
+    telemetry.policy = GetQueryPolicy(policy);
+
+    const Clock::time_point start_time = Clock::now();
+    std::vector<Document> result = search_server_.FindTopDocuments(policy, raw_query, document_filter, telemetry.matched_count);
+    const Clock::time_point end_time = Clock::now();
+    telemetry.latency = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+    AddRequestResult(raw_query, result, telemetry, end_time);
+    return result;
 }
 
 template <typename ExecutionPolicy>
@@ -0,0 +1,10 @@
+#include "scoring.h"
+
+#include <stdexcept>
+
+Bm25Scoring::Bm25Scoring(double k1, double b)
+    : k1(k1), b(b) {
+    if (!(k1 >= 0.0) || !(b >= 0.0 && b <= 1.0)) {
+        throw std::invalid_argument("Invalid BM25 parameters");
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cmath>
+#include <variant>
+
+#include "document_filters.h"
+
+// Модели ранжирования для SearchServer::SetScoring.
+// Модель задаёт IDF слова и вклад одного постинга в релевантность документа.
+// term_freq в индексе - доля слова в документе (вхождения / число слов документа).
+// Модель выбирается один раз на запрос, а цикл по постингам собирается отдельно
+// под каждую модель (TermScorer), поэтому оценка встраивается в цикл целиком.
+
+// TF-IDF, модель по умолчанию: term_freq * log(N / df)
+struct TfIdfScoring {
+    static constexpr bool USES_DOCUMENT_LENGTH = false;
+
+    struct TermScore {
+        double operator()(double term_freq, double inverse_document_freq, double) const {
+            return term_freq * inverse_document_freq;
+        }
+    };
+
+    double ComputeIdf(size_t document_count, size_t word_document_count) const {
+        return std::log(document_count * 1.0 / word_document_count);
+    }
+
+    TermScore Prepare(double) const {
+        return {};
+    }
+};
+
+// Okapi BM25: idf * f * (k1 + 1) / (f + k1 * (1 - b + b * dl / avgdl)),
+// где f - число вхождений, dl - число слов документа, avgdl - среднее по базе.
+// При f = term_freq * dl числитель и знаменатель делятся на dl, и от документа
+// остаётся только 1 / dl - она считается один раз при добавлении документа
+struct Bm25Scoring {
+    static constexpr bool USES_DOCUMENT_LENGTH = true;
+
+    // постоянные на время запроса
+    struct TermScore {
+        double k1_plus_one = 0.0;
+        double length_weight = 0.0;    // k1 * (1 - b)
+        double average_weight = 0.0;   // k1 * b / avgdl
+
+        double operator()(double term_freq, double inverse_document_freq, double inverse_length) const {
+            return inverse_document_freq * k1_plus_one * term_freq
+                / (term_freq + length_weight * inverse_length + average_weight);
+        }
+    };
+
+    explicit Bm25Scoring(double k1 = 1.2, double b = 0.75);
+
+    double ComputeIdf(size_t document_count, size_t word_document_count) const {
+        return std::log(1.0 + (document_count - word_document_count + 0.5) / (word_document_count + 0.5));
+    }
+
+    TermScore Prepare(double average_length) const {
+        return { k1 + 1.0, k1 * (1.0 - b), average_length > 0.0 ? k1 * b / average_length : 0.0 };
+    }
+
+    double k1;
+    double b;
+};
+
+using ScoringModel = std::variant<TfIdfScoring, Bm25Scoring>;
+
+// Оценка постингов моделью Scoring на время одного запроса
+template <typename Scoring>
+class TermScorer {
+public:
+    TermScorer(const Scoring& scoring, const DocumentColumns& columns)
+        : scoring_(scoring), columns_(columns), term_score_(scoring.Prepare(columns.GetAverageLength())) {
+    }
+
+    double ComputeIdf(size_t document_count, size_t word_document_count) const {
+        return scoring_.ComputeIdf(document_count, word_document_count);
+    }
+
+    // cursor - позиция в колонках документов, своя на каждый список постингов
+    double operator()(int document_id, double term_freq, double inverse_document_freq, size_t& cursor) const {
+        if constexpr (Scoring::USES_DOCUMENT_LENGTH) {
+            return term_score_(term_freq, inverse_document_freq, columns_.GetInverseLength(document_id, cursor));
+        }
+        else {
+            return term_score_(term_freq, inverse_document_freq, 0.0);
+        }
+    }
+
+private:
+    const Scoring& scoring_;
+    const DocumentColumns& columns_;
+    const typename Scoring::TermScore term_score_;
+};
@@ -1,4 +1,14 @@
 #include "search_server.h"
+#include "index_format.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
 
 SearchServer::SearchServer(std::string_view stop_words_text) 
     : SearchServer(SplitIntoWords(stop_words_text)) {
@@ -8,43 +18,93 @@ SearchServer::SearchServer(const std::string& stop_words_text)
     : SearchServer(SplitIntoWords(stop_words_text)) {
 }
 
-void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+int SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
     if ((document_id < 0) || (documents_.count(document_id) > 0)) {
         throw std::invalid_argument("Invalid document_id");
     }
 
-    //предварительный чек, чтобы в случае кривого документа ничего не делать и не сохранять в памяти
-    {
-        auto check = SearchServer::SplitIntoWordsNoStop(document);
+    // разбор и проверка за один проход, кривой документ не попадает в память
+    const auto words = SearchServer::SplitIntoWordsNoStop(document);
+
+    // проверка дубликата - до любых изменений базы
+    std::optional<DocumentFingerprint> fingerprint;
+    if (fingerprint_index_ && !words.empty()) {
+        std::vector<std::string_view> unique_words(words.begin(), words.end());
+        std::sort(unique_words.begin(), unique_words.end());
+        unique_words.erase(std::unique(unique_words.begin(), unique_words.end()), unique_words.end());
+        fingerprint.emplace();
+        for (std::string_view word : unique_words) {
+            fingerprint->AddWord(word);
+        }
+        if (const auto original = FindOriginal(*fingerprint, unique_words)) {
+            switch (duplicate_policy_) {
+            case DuplicatePolicy::SKIP:
+                return *original;
+            case DuplicatePolicy::REJECT:
+                throw std::invalid_argument("Duplicate document");
+            case DuplicatePolicy::RECORD:
+                duplicate_records_.push_back({ document_id, *original });
+                break;
+            case DuplicatePolicy::ALLOW:
+                break;
+            }
+        }
     }
     
-    // создаём строку из string_view для передачи на хранение
-    const std::string document_string{ document };
-
-    //вставляем строку в documents_ там и храним в дальнейшем
-    documents_.emplace(document_id, DocumentData{ SearchServer::ComputeAverageRating(ratings), status, document_string });
+    // копируем текст в хранилище, адрес копии не меняется до удаления документа
+    const std::string_view document_text = texts_.Store(document);
 
-    const auto words = SearchServer::SplitIntoWordsNoStop(documents_.at(document_id).text_);
+    const int rating = SearchServer::ComputeAverageRating(ratings);
+    documents_.emplace(document_id, DocumentData{ rating, status, document_text });
+    document_columns_.Insert(document_id, status, rating, words.size());
 
     const double inv_word_count = 1.0 / words.size();
     for (std::string_view word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][word] += inv_word_count;
+        // переносим слово из входной строки на сохранённую копию текста
+        const std::string_view stored_word(document_text.data() + (word.data() - document.data()), word.size());
+        auto& word_postings = word_to_document_freqs_[stored_word];
+        if (fuzzy_index_ && word_postings.empty()) {
+            fuzzy_index_->AddTerm(stored_word);
+        }
+        word_postings[document_id] += inv_word_count;
+        document_to_word_freqs_[document_id][stored_word] += inv_word_count;
     }
+    for (const auto& [word, term_freq] : document_to_word_freqs_[document_id]) {
+        AddStatusPosting(word, document_id, status, term_freq);
+    }
+    if (positional_index_) {
+        BuildDocumentPositions(document_id, document_text);
+    }
+    if (fingerprint) {
+        fingerprint_index_->Add(*fingerprint, document_id);
+    }
+    impact_index_.reset();
 
     document_ids_.insert(document_id);
+    generation_ = NextGeneration();
+    return document_id;
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-        });
+    return FindTopDocuments(std::execution::seq, raw_query, status);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query) const {
     return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
 }
 
+DocumentsPage SearchServer::FindDocumentsPage(std::string_view raw_query, size_t offset, size_t page_size) const {
+    return FindDocumentsPage(std::execution::seq, raw_query, DocumentStatus::ACTUAL, offset, page_size);
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByRating(std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocumentsByRating(raw_query, StatusIs(status));
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByRating(std::string_view raw_query) const {
+    return FindTopDocumentsByRating(raw_query, DocumentStatus::ACTUAL);
+}
+
 const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int document_id) const {
     if (document_to_word_freqs_.count(document_id)) {
         return document_to_word_freqs_.at(document_id);
@@ -56,30 +116,56 @@ const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int d
 
 void SearchServer::RemoveDocument(int document_id) {
     
-    // Чистим std::set<int> document_ids_;
     if (!document_ids_.count(document_id)) {
         using namespace std::literals::string_literals;
         throw std::invalid_argument("Invalid document ID to remove"s);
     }
+    EraseDocument(document_id);
+    document_columns_.Erase(document_id);
+    generation_ = NextGeneration();
+}
 
-    document_ids_.erase(document_id);
-    
-    // Чистим std::map<int, DocumentData> documents_;
-    if (documents_.count(document_id)) {
-        documents_.erase(document_id);
+void SearchServer::RemoveDocuments(std::vector<int> document_ids) {
+    std::sort(document_ids.begin(), document_ids.end());
+    document_ids.erase(std::unique(document_ids.begin(), document_ids.end()), document_ids.end());
+    // все id проверяются до удаления, при ошибке база не меняется
+    if (!std::all_of(document_ids.begin(), document_ids.end(), [this](int document_id) { return document_ids_.count(document_id) > 0; })) {
+        using namespace std::literals::string_literals;
+        throw std::invalid_argument("Invalid document ID to remove"s);
     }
+    for (int document_id : document_ids) {
+        EraseDocument(document_id);
+    }
+    document_columns_.Erase(document_ids);
+    generation_ = NextGeneration();
+}
+
+void SearchServer::EraseDocument(int document_id) {
+
+    EraseFingerprint(document_id);
+
+    // Чистим std::set<int> document_ids_;
+    document_ids_.erase(document_id);
 
-    // чистим std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    for (auto& element : SearchServer::word_to_document_freqs_) {
-        if (element.second.count(document_id)) {
-            element.second.erase(document_id);
+    // чистим std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
+    const auto document_words = document_to_word_freqs_.find(document_id);
+    if (document_words != document_to_word_freqs_.end()) {
+        const DocumentStatus status = documents_.at(document_id).status_;
+        for (const auto& [word, _] : document_words->second) {
+            word_to_document_freqs_.at(word).erase(document_id);
+            EraseStatusPosting(word, document_id, status);
         }
-    }
+        EraseFromWordIndex(document_id, document_words->second);
 
-    // чистим std::map<int, std::map<std::string, double>> document_to_word_freqs_;
-    if (document_to_word_freqs_.count(document_id)) {
-        document_to_word_freqs_.erase(document_id);
+        // чистим std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
+        document_to_word_freqs_.erase(document_words);
     }
+
+    // Чистим std::map<int, DocumentData> documents_ и освобождаем текст;
+    texts_.Release(documents_.at(document_id).text_);
+    documents_.erase(document_id);
+    document_positions_.erase(document_id);
+    impact_index_.reset();
 }
 
 void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int document_id) {
@@ -89,21 +175,33 @@ void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int do
         throw std::invalid_argument("Invalid document ID to remove"s);
     }
 
+    EraseFingerprint(document_id);
+
     //версия на векторе указателей на words
-    std::map<std::string_view, double> word_freqs_ = document_to_word_freqs_.at(document_id);
+    const std::map<std::string_view, double>& word_freqs_ = GetWordFrequencies(document_id);
     std::vector<std::string_view> words_(word_freqs_.size());
 
     std::transform(std::execution::par, word_freqs_.begin(), word_freqs_.end(), words_.begin(),
         [](const auto item) { return item.first; });
 
+    // внутренние словари разных слов независимы и чистятся параллельно
+    const DocumentStatus status = documents_.at(document_id).status_;
     std::for_each(std::execution::par, words_.begin(), words_.end(),
-        [this, document_id](std::string_view word) {
-            word_to_document_freqs_.at(word).erase(document_id); });
+        [this, document_id, status](std::string_view word) {
+            word_to_document_freqs_.at(word).erase(document_id);
+            EraseStatusPosting(word, document_id, status); });
+
+    // перестройка самого словаря слов - последовательно
+    EraseFromWordIndex(document_id, word_freqs_);
 
     document_to_word_freqs_.erase(document_id);
     document_ids_.erase(document_id);
+    texts_.Release(documents_.at(document_id).text_);
     documents_.erase(document_id);
-
+    document_columns_.Erase(document_id);
+    document_positions_.erase(document_id);
+    impact_index_.reset();
+    generation_ = NextGeneration();
 }
 
 std::tuple<std::vector<std::string_view>, DocumentStatus>
@@ -114,24 +212,29 @@ SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
 std::tuple<std::vector<std::string_view>, DocumentStatus>
 SearchServer::MatchDocument(const std::execution::sequenced_policy&, std::string_view raw_query, int document_id) const {
     
-    const auto query = ParseVecQueryWSD(raw_query);
+    QueryMemory::Scope query_scope;
+    return MatchQueryDocument(ParseVecQueryWSD(raw_query, QueryMemory::GetResource()), document_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+SearchServer::MatchQueryDocument(const VecQueryWSD& query, int document_id) const {
 
     std::vector<std::string_view> matched_words;
 
     for (std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        const auto it = word_to_document_freqs_.find(word);
+        if (it != word_to_document_freqs_.end() && it->second.count(document_id)) {
             return { matched_words, documents_.at(document_id).status_ };
         }
     }
 
+    if (!MatchesPhrases(document_id, query)) {
+        return { matched_words, documents_.at(document_id).status_ };
+    }
+
     for (std::string_view word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        const auto it = word_to_document_freqs_.find(word);
+        if (it != word_to_document_freqs_.end() && it->second.count(document_id)) {
             matched_words.push_back(word);
         }
     }
@@ -142,16 +245,25 @@ SearchServer::MatchDocument(const std::execution::sequenced_policy&, std::string
 std::tuple<std::vector<std::string_view>, DocumentStatus>
 SearchServer::MatchDocument(const std::execution::parallel_policy&, std::string_view raw_query, int document_id) const {
 
+    // фразы, префиксы и слова с опечатками разбираются только последовательной версией
+    if (fuzzy_index_ || raw_query.find_first_of("\"*") != std::string_view::npos) {
+        return MatchDocument(std::execution::seq, raw_query, document_id);
+    }
+
     const auto query = ParseVecQueryNOSD(raw_query);
 
     // сразу ищем минуса, если таковые будут то выходим из функции с нулем.
     if (std::any_of(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
-        [this, document_id](std::string_view word) {return word_to_document_freqs_.at(word).count(document_id); })) {
+        [this, document_id](std::string_view word) {
+            const auto it = word_to_document_freqs_.find(word);
+            return it != word_to_document_freqs_.end() && it->second.count(document_id); })) {
         return { {}, documents_.at(document_id).status_ };
     }
 
     std::vector<std::string_view> matched_words(query.plus_words.size());
-    auto end_it = std::copy_if(std::execution::par, query.plus_words.begin(), query.plus_words.end(), matched_words.begin(), [this, document_id](std::string_view word) {return word_to_document_freqs_.at(word).count(document_id); });
+    auto end_it = std::copy_if(std::execution::par, query.plus_words.begin(), query.plus_words.end(), matched_words.begin(), [this, document_id](std::string_view word) {
+        const auto it = word_to_document_freqs_.find(word);
+        return it != word_to_document_freqs_.end() && it->second.count(document_id); });
 
     std::sort(matched_words.begin(), end_it);
     end_it = unique(matched_words.begin(), end_it);
@@ -160,6 +272,249 @@ SearchServer::MatchDocument(const std::execution::parallel_policy&, std::string_
     return { matched_words, documents_.at(document_id).status_ };
 }
 
+std::vector<DocumentMatch> SearchServer::MatchDocuments(std::string_view raw_query) const {
+    return MatchDocuments(std::execution::seq, raw_query);
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(std::string_view raw_query, const std::vector<int>& document_ids) const {
+    return MatchDocuments(std::execution::seq, raw_query, document_ids);
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const std::execution::sequenced_policy&, std::string_view raw_query,
+    const std::vector<int>& document_ids) const {
+    QueryMemory::Scope query_scope;
+    return MatchQueryDocuments(ParseVecQueryWSD(raw_query, QueryMemory::GetResource()), document_ids, 1);
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const std::execution::parallel_policy&, std::string_view raw_query,
+    const std::vector<int>& document_ids) const {
+    QueryMemory::Scope query_scope;
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return MatchQueryDocuments(ParseVecQueryWSD(raw_query, QueryMemory::GetResource()), document_ids,
+        4 * (hardware_threads != 0 ? hardware_threads : 2));
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const AutoExecution& policy, std::string_view raw_query,
+    const std::vector<int>& document_ids) const {
+    QueryMemory::Scope query_scope;
+    const auto query = ParseVecQueryWSD(raw_query, QueryMemory::GetResource());
+    QueryCost cost = EstimateQueryCost(query, std::nullopt);
+    // при сопоставлении с частью базы просматривается не больше постингов, чем документов на слово
+    if (document_ids.size() < document_columns_.size()) {
+        cost.posting_count = std::min(cost.posting_count, document_ids.size() * cost.term_count);
+    }
+    const ExecutionPlan plan = ChooseExecution(cost, policy);
+    // слова одного документа не делятся между потоками, параллельный ход здесь всегда по документам
+    return MatchQueryDocuments(query, document_ids, plan.mode == ExecutionMode::SEQUENTIAL ? 1 : plan.thread_count);
+}
+
+SearchServer::PreparedQuery SearchServer::Prepare(std::string_view raw_query) const {
+    PreparedQuery result;
+    result.text_ = std::make_unique<const std::string>(raw_query);
+    // запрос живёт дольше вызова, его память - из ресурса по умолчанию, а не из памяти запроса потока
+    VecQueryWSD query = ParseVecQueryWSD(*result.text_);
+
+    // слова ссылаются на ключи словаря, слов вне словаря нет: они не находят и не исключают документы.
+    // Порядок plus_words не меняется, по нему ищутся IDF
+    auto resolve = [this](std::pmr::vector<std::string_view>& words) {
+        auto out = words.begin();
+        for (std::string_view word : words) {
+            const auto it = word_to_document_freqs_.find(word);
+            if (it != word_to_document_freqs_.end()) {
+                *out++ = it->first;
+            }
+        }
+        words.erase(out, words.end());
+    };
+    resolve(query.plus_words);
+    resolve(query.minus_words);
+
+    std::pmr::vector<double> idf(query.plus_words.get_allocator());
+    idf.reserve(query.plus_words.size());
+    WithTermScorer([this, &query, &idf](const auto& scorer) {
+        for (std::string_view word : query.plus_words) {
+            idf.push_back(ComputeQueryWordIdf(scorer, query, word));
+        }
+        });
+    query.plus_word_idf = std::move(idf);
+
+    result.query_ = std::move(query);
+    result.server_ = this;
+    result.generation_ = generation_;
+    return result;
+}
+
+uint64_t SearchServer::NextGeneration() {
+    static std::atomic<uint64_t> next_generation{ 1 };
+    return next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SearchServer::IsCurrent(const PreparedQuery& query) const {
+    return query.server_ == this && query.generation_ == generation_;
+}
+
+void SearchServer::Refresh(PreparedQuery& query) const {
+    if (!IsCurrent(query)) {
+        query = Prepare(query.GetText());
+    }
+}
+
+const SearchServer::VecQueryWSD& SearchServer::GetPreparedQuery(const PreparedQuery& query, std::optional<VecQueryWSD>& local_query) const {
+    if (!IsCurrent(query)) {
+        // ключи словаря, на которые ссылается запрос, могли уйти вместе с документами - разбор заново
+        return local_query.emplace(ParseVecQueryWSD(query.GetText(), QueryMemory::GetResource()));
+    }
+    VecQueryWSD& result = local_query.emplace(QueryMemory::GetResource());
+    result.plus_words.assign(query.query_.plus_words.begin(), query.query_.plus_words.end());
+    result.minus_words.assign(query.query_.minus_words.begin(), query.query_.minus_words.end());
+    result.phrases.assign(query.query_.phrases.begin(), query.query_.phrases.end());
+    result.group_document_count.insert(query.query_.group_document_count.begin(), query.query_.group_document_count.end());
+    result.plus_word_idf.assign(query.query_.plus_word_idf.begin(), query.query_.plus_word_idf.end());
+    return result;
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& query) const {
+    return FindTopDocuments(std::execution::seq, query, DocumentStatus::ACTUAL);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus>
+SearchServer::MatchDocument(const PreparedQuery& query, int document_id) const {
+    QueryMemory::Scope query_scope;
+    std::optional<VecQueryWSD> local_query;
+    return MatchQueryDocument(GetPreparedQuery(query, local_query), document_id);
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const PreparedQuery& query) const {
+    return MatchDocuments(query, std::vector<int>(begin(), end()));
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const PreparedQuery& query, const std::vector<int>& document_ids) const {
+    QueryMemory::Scope query_scope;
+    std::optional<VecQueryWSD> local_query;
+    return MatchQueryDocuments(GetPreparedQuery(query, local_query), document_ids, 1);
+}
+
+std::vector<DocumentMatch> SearchServer::MatchDocuments(const std::execution::parallel_policy&, const PreparedQuery& query,
+    const std::vector<int>& document_ids) const {
+    QueryMemory::Scope query_scope;
+    std::optional<VecQueryWSD> local_query;
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return MatchQueryDocuments(GetPreparedQuery(query, local_query), document_ids,
+        4 * (hardware_threads != 0 ? hardware_threads : 2));
+}
+
+std::vector<DocumentMatch> SearchServer::MatchQueryDocuments(const VecQueryWSD& query, const std::vector<int>& document_ids,
+    size_t max_ranges) const {
+
+    // документы сопоставляются по возрастанию id
+    const bool is_sorted = std::adjacent_find(document_ids.begin(), document_ids.end(), std::greater_equal<int>()) == document_ids.end();
+    std::vector<int> sorted_ids;
+    if (!is_sorted) {
+        sorted_ids = document_ids;
+        std::sort(sorted_ids.begin(), sorted_ids.end());
+        sorted_ids.erase(std::unique(sorted_ids.begin(), sorted_ids.end()), sorted_ids.end());
+    }
+    const std::vector<int>& ids = is_sorted ? document_ids : sorted_ids;
+
+    // статусы берутся из колонок, id идут в том же порядке
+    std::vector<DocumentMatch> matches(ids.size());
+    const std::vector<int>& column_ids = document_columns_.GetIds();
+    size_t slot = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        slot = document_columns_.FindSlotFrom(ids[i], slot);
+        if (slot == column_ids.size() || column_ids[slot] != ids[i]) {
+            using namespace std::literals::string_literals;
+            throw std::out_of_range("Invalid document_id"s);
+        }
+        matches[i].document_id = ids[i];
+        matches[i].status = document_columns_.GetStatuses()[slot];
+    }
+
+    const size_t range_count = std::max<size_t>(1, std::min(matches.size(), max_ranges));
+    std::vector<size_t> ranges(range_count);
+    std::iota(ranges.begin(), ranges.end(), 0);
+    const auto match_range = [this, &query, &matches, range_count](size_t range) {
+        MatchDocumentRange(query, matches, matches.size() * range / range_count, matches.size() * (range + 1) / range_count);
+    };
+    if (range_count > 1) {
+        std::for_each(std::execution::par, ranges.begin(), ranges.end(), match_range);
+    }
+    else {
+        std::for_each(ranges.begin(), ranges.end(), match_range);
+    }
+
+    // фразы проверяются последовательно: проверка берёт память из ресурса запроса
+    if (!query.phrases.empty()) {
+        for (DocumentMatch& match : matches) {
+            if (!match.words.empty() && !MatchesPhrases(match.document_id, query)) {
+                match.words.clear();
+            }
+        }
+    }
+
+    if (is_sorted) {
+        return matches;
+    }
+    std::vector<DocumentMatch> result;
+    result.reserve(document_ids.size());
+    for (int document_id : document_ids) {
+        result.push_back(*std::lower_bound(matches.begin(), matches.end(), document_id,
+            [](const DocumentMatch& match, int id) { return match.document_id < id; }));
+    }
+    return result;
+}
+
+void SearchServer::MatchDocumentRange(const VecQueryWSD& query, std::vector<DocumentMatch>& matches, size_t begin, size_t end) const {
+    if (begin == end) {
+        return;
+    }
+    const int first_id = matches[begin].document_id;
+    const int last_id = matches[end - 1].document_id;
+    const auto by_id = [](const DocumentMatch& match, int id) { return match.document_id < id; };
+
+    // func(i) для каждого документа matches[begin, end), в котором есть слово
+    const auto for_each_match = [&](std::string_view word, auto func) {
+        const auto word_postings = word_to_document_freqs_.find(word);
+        if (word_postings == word_to_document_freqs_.end()) {
+            return;
+        }
+        const std::map<int, double>& postings = word_postings->second;
+        if (postings.size() <= end - begin) {
+            // идём по постингам диапазона, документы ищутся от предыдущего найденного
+            size_t i = begin;
+            for (auto it = postings.lower_bound(first_id); it != postings.end() && it->first <= last_id; ++it) {
+                i = std::lower_bound(matches.begin() + i, matches.begin() + end, it->first, by_id) - matches.begin();
+                if (i == end) {
+                    break;
+                }
+                if (matches[i].document_id == it->first) {
+                    func(i);
+                }
+            }
+        }
+        else {
+            // документов меньше, чем постингов - ищем их в постингах
+            for (size_t i = begin; i < end; ++i) {
+                if (postings.count(matches[i].document_id)) {
+                    func(i);
+                }
+            }
+        }
+    };
+
+    std::vector<bool> excluded(end - begin);
+    for (std::string_view word : query.minus_words) {
+        for_each_match(word, [&excluded, begin](size_t i) { excluded[i - begin] = true; });
+    }
+    // слова добавляются в порядке plus_words, как у MatchDocument
+    for (std::string_view word : query.plus_words) {
+        for_each_match(word, [&matches, &excluded, begin, word](size_t i) {
+            if (!excluded[i - begin]) {
+                matches[i].words.push_back(word);
+            }
+        });
+    }
+}
 
 int SearchServer::GetDocumentId(int index) const {
     if (index >= 0 && index < GetDocumentCount()) {
@@ -169,12 +524,364 @@ int SearchServer::GetDocumentId(int index) const {
     throw std::out_of_range("index out of range");
 }
 
-SearchServer::DocumentData::DocumentData(int rating, DocumentStatus status, std::string text)
+SearchServer::DocumentData::DocumentData(int rating, DocumentStatus status, std::string_view text)
     : rating_(rating), status_(status), text_(text) {
 }
 
 bool SearchServer::IsStopWord(std::string_view word) const {
-    return stop_words_.count(word) > 0;
+    return stop_words_filter_.Contains(word);
+}
+
+void SearchServer::EraseFromWordIndex(int document_id, const std::map<std::string_view, double>& word_freqs) {
+    const std::string_view text = documents_.at(document_id).text_;
+    for (const auto& [word, _] : word_freqs) {
+        auto it = word_to_document_freqs_.find(word);
+        if (it->second.empty()) {
+            word_to_document_freqs_.erase(it);
+            word_to_status_postings_.erase(word);
+            if (fuzzy_index_) {
+                fuzzy_index_->RemoveTerm(word);
+            }
+            continue;
+        }
+        // ключ указывает в текст удаляемого документа - переносим его на вхождение в другом документе
+        if (it->first.data() >= text.data() && it->first.data() < text.data() + text.size()) {
+            const std::string_view new_key = document_to_word_freqs_.at(it->second.begin()->first).find(word)->first;
+            auto node = word_to_document_freqs_.extract(it);
+            node.key() = new_key;
+            word_to_document_freqs_.insert(std::move(node));
+            auto status_node = word_to_status_postings_.extract(word);
+            status_node.key() = new_key;
+            word_to_status_postings_.insert(std::move(status_node));
+        }
+    }
+}
+
+void SearchServer::AddStatusPosting(std::string_view word, int document_id, DocumentStatus status, double term_freq) {
+    auto& postings = word_to_status_postings_[word][static_cast<size_t>(status)];
+    // документы обычно добавляются по возрастанию id - тогда это просто вставка в конец
+    if (postings.empty() || postings.back().first < document_id) {
+        postings.emplace_back(document_id, term_freq);
+    }
+    else {
+        const auto it = std::lower_bound(postings.begin(), postings.end(), std::make_pair(document_id, 0.0));
+        postings.emplace(it, document_id, term_freq);
+    }
+}
+
+void SearchServer::EraseStatusPosting(std::string_view word, int document_id, DocumentStatus status) {
+    auto& postings = word_to_status_postings_.find(word)->second[static_cast<size_t>(status)];
+    const auto it = std::lower_bound(postings.begin(), postings.end(), std::make_pair(document_id, 0.0));
+    postings.erase(it);
+}
+
+void SearchServer::BuildDocumentPositions(int document_id, std::string_view text) {
+    // позиции считаются по всем словам текста, включая стоп-слова
+    const std::vector<std::string_view> words = SplitIntoWords(text);
+    std::vector<std::pair<std::string_view, uint32_t>> word_positions;
+    word_positions.reserve(words.size());
+    for (uint32_t position = 0; position < words.size(); ++position) {
+        if (!IsStopWord(words[position])) {
+            word_positions.emplace_back(words[position], position);
+        }
+    }
+    document_positions_[document_id] = DocumentPositions(std::move(word_positions));
+}
+
+void SearchServer::SetPositionalIndex(bool enabled) {
+    positional_index_ = enabled;
+    generation_ = NextGeneration();
+    if (!enabled) {
+        document_positions_.clear();
+        return;
+    }
+    for (const auto& [document_id, document_data] : documents_) {
+        if (document_positions_.count(document_id) == 0) {
+            BuildDocumentPositions(document_id, document_data.text_);
+        }
+    }
+}
+
+void SearchServer::SetFuzzySearch(int max_distance) {
+    generation_ = NextGeneration();
+    if (max_distance == 0) {
+        fuzzy_index_.reset();
+        return;
+    }
+    FuzzyIndex fuzzy_index(max_distance);
+    for (const auto& [word, _] : word_to_document_freqs_) {
+        fuzzy_index.AddTerm(word);
+    }
+    fuzzy_index_ = std::move(fuzzy_index);
+}
+
+void SearchServer::SetDuplicatePolicy(DuplicatePolicy policy) {
+    duplicate_policy_ = policy;
+    if (policy == DuplicatePolicy::ALLOW) {
+        fingerprint_index_.reset();
+        return;
+    }
+    if (fingerprint_index_) {
+        return;
+    }
+    const std::vector<int> document_ids(document_ids_.begin(), document_ids_.end());
+    std::vector<DocumentFingerprint> fingerprints(document_ids.size());
+    std::transform(std::execution::par, document_ids.begin(), document_ids.end(), fingerprints.begin(),
+        [this](int document_id) { return ComputeFingerprint(GetWordFrequencies(document_id)); });
+
+    FingerprintIndex fingerprint_index;
+    for (size_t i = 0; i < document_ids.size(); ++i) {
+        if (!GetWordFrequencies(document_ids[i]).empty()) {
+            fingerprint_index.Add(fingerprints[i], document_ids[i]);
+        }
+    }
+    fingerprint_index_ = std::move(fingerprint_index);
+}
+
+std::optional<int> SearchServer::FindOriginal(const DocumentFingerprint& fingerprint, const std::vector<std::string_view>& words) const {
+    const std::vector<int>* document_ids = fingerprint_index_->Find(fingerprint);
+    if (!document_ids) {
+        return std::nullopt;
+    }
+    // совпадение отпечатков проверяется по самим словам
+    for (int document_id : *document_ids) {
+        const auto& word_freqs = document_to_word_freqs_.at(document_id);
+        if (std::equal(words.begin(), words.end(), word_freqs.begin(), word_freqs.end(),
+            [](std::string_view word, const auto& item) { return word == item.first; })) {
+            return document_id;
+        }
+    }
+    return std::nullopt;
+}
+
+void SearchServer::EraseFingerprint(int document_id) {
+    if (!fingerprint_index_) {
+        return;
+    }
+    const auto& word_freqs = GetWordFrequencies(document_id);
+    if (!word_freqs.empty()) {
+        fingerprint_index_->Remove(ComputeFingerprint(word_freqs), document_id);
+    }
+}
+
+void SearchServer::BuildImpactIndex() {
+    impact_index_.reset();
+    WithTermScorer([this](const auto& scorer) {
+        // func(word, status_index, scores) для каждого непустого списка постингов
+        const auto for_each_list = [this, &scorer](auto func) {
+            std::vector<double> scores;
+            for (const auto& [word, status_postings] : word_to_status_postings_) {
+                const double inverse_document_freq = scorer.ComputeIdf(GetDocumentCount(), word_to_document_freqs_.at(word).size());
+                for (size_t status_index = 0; status_index < STATUS_COUNT; ++status_index) {
+                    if (status_postings[status_index].empty()) {
+                        continue;
+                    }
+                    scores.clear();
+                    size_t cursor = 0;
+                    for (const auto& [document_id, term_freq] : status_postings[status_index]) {
+                        scores.push_back(scorer(document_id, term_freq, inverse_document_freq, cursor));
+                    }
+                    func(word, status_index, scores);
+                }
+            }
+        };
+
+        // шаг квантования выбирается по наибольшему вкладу, затем вклады пересчитываются в единицы шага
+        double max_score = 0.0;
+        for_each_list([&max_score](std::string_view, size_t, const std::vector<double>& scores) {
+            max_score = std::max(max_score, *std::max_element(scores.begin(), scores.end()));
+            });
+        ImpactIndex impact_index(max_score);
+        for_each_list([this, &impact_index](std::string_view word, size_t status_index, const std::vector<double>& scores) {
+            const auto& status_postings = word_to_status_postings_.at(word)[status_index];
+            ImpactIndex::Postings& postings = impact_index.GetPostings(word, status_index);
+            postings.slots.reserve(scores.size());
+            postings.impacts.reserve(scores.size());
+            size_t cursor = 0;
+            for (size_t i = 0; i < scores.size(); ++i) {
+                cursor = document_columns_.FindSlotFrom(status_postings[i].first, cursor);
+                postings.slots.push_back(static_cast<uint32_t>(cursor));
+                postings.impacts.push_back(impact_index.Quantize(scores[i]));
+            }
+            ImpactIndex::BuildOrder(postings);
+            });
+        impact_index_ = std::move(impact_index);
+        });
+}
+
+size_t SearchServer::GetImpactIndexByteSize() const {
+    return impact_index_ ? impact_index_->GetByteSize() : 0;
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByImpact(const VecQueryWSD& query, DocumentStatus status,
+    size_t& matched_count) const {
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    const size_t status_index = static_cast<size_t>(status);
+
+    // целые суммы вкладов по позициям документов в колонках
+    std::pmr::vector<uint32_t> sums(document_columns_.size(), 0, resource);
+    size_t word_count = 0;
+    for (std::string_view word : query.plus_words) {
+        if (const ImpactIndex::Postings* postings = impact_index_->FindPostings(word, status_index)) {
+            ImpactIndex::Accumulate(*postings, sums.data());
+            ++word_count;
+        }
+    }
+    for (std::string_view word : query.minus_words) {
+        if (const ImpactIndex::Postings* postings = impact_index_->FindPostings(word, status_index)) {
+            for (uint32_t slot : postings->slots) {
+                sums[slot] = 0;
+            }
+        }
+    }
+
+    std::pmr::vector<uint32_t> matched_slots(resource);
+    for (uint32_t slot = 0; slot < sums.size(); ++slot) {
+        if (sums[slot] != 0) {
+            matched_slots.push_back(slot);
+        }
+    }
+    matched_count = matched_slots.size();
+    if (matched_slots.empty()) {
+        return {};
+    }
+
+    // Точная релевантность отличается от суммы вкладов не больше чем на word_count шагов.
+    // Документ, сумма которого ниже K-й суммы больше чем на 2 * word_count шагов и RELEVANCE_THRESHOLD,
+    // точно менее релевантен каждого из K лучших, поэтому точно пересчитываются только документы выше этой границы.
+    // Равные K-му документы остаются среди кандидатов, и выбор между ними по id тот же, что и без индекса
+    const size_t top_count = std::min<size_t>(MAX_RESULT_DOCUMENT_COUNT, matched_slots.size());
+    std::nth_element(matched_slots.begin(), matched_slots.begin() + (top_count - 1), matched_slots.end(),
+        [&sums](uint32_t lhs, uint32_t rhs) { return sums[lhs] > sums[rhs]; });
+    const double kth_sum = sums[matched_slots[top_count - 1]];
+    const double bound = kth_sum - 2.0 * word_count - std::ceil(RELEVANCE_THRESHOLD / impact_index_->GetStep());
+
+    std::pmr::vector<Document> candidates(resource);
+    for (uint32_t slot : matched_slots) {
+        if (sums[slot] >= bound) {
+            const int document_id = document_columns_.GetIds()[slot];
+            candidates.push_back({ document_id, ComputeRelevance(document_id, query), document_columns_.GetRatings()[slot] });
+        }
+    }
+    const auto top_end = SelectDocumentsRange(std::execution::seq, candidates.begin(), candidates.end(),
+        0, MAX_RESULT_DOCUMENT_COUNT);
+    return { candidates.begin(), top_end };
+}
+
+std::vector<Document> SearchServer::FindTopDocumentsByImpactOrder(const VecQueryWSD& query, DocumentStatus status,
+    size_t* matched_count) const {
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    const size_t status_index = static_cast<size_t>(status);
+
+    const auto find_lists = [this, resource, status_index](const std::pmr::vector<std::string_view>& words) {
+        std::pmr::vector<const ImpactIndex::Postings*> lists(resource);
+        for (std::string_view word : words) {
+            const ImpactIndex::Postings* postings = impact_index_->FindPostings(word, status_index);
+            if (postings && !postings->slots.empty()) {
+                lists.push_back(postings);
+            }
+        }
+        return lists;
+    };
+    const auto lists = find_lists(query.plus_words);
+    const auto excluded_lists = find_lists(query.minus_words);
+    if (matched_count) {
+        *matched_count = lists.empty() ? 0 : lists[0]->slots.size();
+    }
+    if (lists.empty()) {
+        return {};
+    }
+
+    // порядок по убыванию вкладов, для коротких списков он строится здесь
+    std::pmr::vector<std::pmr::vector<uint32_t>> local_orders(resource);
+    local_orders.reserve(lists.size());
+    std::pmr::vector<const uint32_t*> orders(resource);
+    for (const ImpactIndex::Postings* postings : lists) {
+        if (postings->order.empty()) {
+            ImpactIndex::FillOrder(*postings, local_orders.emplace_back());
+            orders.push_back(local_orders.back().data());
+        }
+        else {
+            orders.push_back(postings->order.data());
+        }
+    }
+
+    // суммы лучших MAX_RESULT_DOCUMENT_COUNT документов, наименьшая - в вершине кучи
+    std::pmr::vector<uint32_t> top_sums(resource);
+    const auto push_top = [&top_sums](uint32_t sum) {
+        if (top_sums.size() < MAX_RESULT_DOCUMENT_COUNT) {
+            top_sums.push_back(sum);
+            std::push_heap(top_sums.begin(), top_sums.end(), std::greater<uint32_t>());
+        }
+        else if (sum > top_sums.front()) {
+            std::pop_heap(top_sums.begin(), top_sums.end(), std::greater<uint32_t>());
+            top_sums.back() = sum;
+            std::push_heap(top_sums.begin(), top_sums.end(), std::greater<uint32_t>());
+        }
+    };
+    // запас на ошибку квантования, как в FindTopDocumentsByImpact
+    const double margin = 2.0 * lists.size() + std::ceil(RELEVANCE_THRESHOLD / impact_index_->GetStep());
+    const auto selection_bound = [&top_sums, margin]() {
+        return top_sums.size() < MAX_RESULT_DOCUMENT_COUNT ? 0.0 : top_sums.front() - margin;
+    };
+
+    // просмотренные документы: (позиция, сумма вкладов)
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> seen(resource);
+    std::pmr::unordered_set<uint32_t> seen_slots(resource);
+    for (size_t depth = 0;; ++depth) {
+        // не просмотренный документ в каждом списке стоит глубже, его сумма не больше суммы вкладов на этой глубине
+        uint32_t unseen_bound = 0;
+        bool has_postings = false;
+        for (size_t list = 0; list < lists.size(); ++list) {
+            const ImpactIndex::Postings* postings = lists[list];
+            if (depth >= postings->slots.size()) {
+                continue;
+            }
+            has_postings = true;
+            const uint32_t index = orders[list][depth];
+            unseen_bound += postings->impacts[index];
+
+            // документ из нескольких списков считается один раз, при первой встрече
+            const uint32_t slot = postings->slots[index];
+            if (lists.size() > 1 && !seen_slots.insert(slot).second) {
+                continue;
+            }
+            const bool is_excluded = std::any_of(excluded_lists.begin(), excluded_lists.end(),
+                [slot](const ImpactIndex::Postings* excluded) { return ImpactIndex::FindImpact(*excluded, slot) != 0; });
+            if (is_excluded) {
+                continue;
+            }
+            uint32_t sum = 0;
+            for (const ImpactIndex::Postings* other : lists) {
+                sum += other == postings ? postings->impacts[index] : ImpactIndex::FindImpact(*other, slot);
+            }
+            seen.emplace_back(slot, sum);
+            push_top(sum);
+        }
+        if (!has_postings || unseen_bound < selection_bound()) {
+            break;
+        }
+    }
+
+    const double bound = selection_bound();
+    std::pmr::vector<Document> candidates(resource);
+    for (const auto& [slot, sum] : seen) {
+        if (sum >= bound) {
+            const int document_id = document_columns_.GetIds()[slot];
+            candidates.push_back({ document_id, ComputeRelevance(document_id, query), document_columns_.GetRatings()[slot] });
+        }
+    }
+    const auto top_end = SelectDocumentsRange(std::execution::seq, candidates.begin(), candidates.end(),
+        0, MAX_RESULT_DOCUMENT_COUNT);
+    return { candidates.begin(), top_end };
+}
+
+size_t SearchServer::GetPositionsByteSize() const {
+    size_t size = 0;
+    for (const auto& [_, positions] : document_positions_) {
+        size += positions.GetByteSize();
+    }
+    return size;
 }
 
 bool SearchServer::IsValidWord(std::string_view word) {
@@ -186,15 +893,13 @@ bool SearchServer::IsValidWord(std::string_view word) {
 
 std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text) const {
     std::vector<std::string_view> words;
-    for (std::string_view word : SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
-            std::string string_word{ word };
-            throw std::invalid_argument("Word {\"" + string_word + "\"} is invalid");
-        }
-        if (!IsStopWord(word)) {
-            words.push_back(word);
-        }
+    const size_t invalid_pos = SplitIntoWordsValidated(text, words);
+    if (invalid_pos != std::string_view::npos) {
+        std::string string_word{ GetWordAt(text, invalid_pos) };
+        throw std::invalid_argument("Word {\"" + string_word + "\"} is invalid");
     }
+    words.erase(std::remove_if(words.begin(), words.end(),
+        [this](std::string_view word) { return IsStopWord(word); }), words.end());
     return words;
 }
 
@@ -210,7 +915,7 @@ SearchServer::QueryWord::QueryWord(std::string_view data, bool is_minus, bool is
     : data(data), is_minus(is_minus), is_stop(is_stop) {
 }
 
-SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {
+SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text, bool chars_checked) const {
     if (text.empty()) {
         throw std::invalid_argument("Query word is empty");
     }
@@ -220,7 +925,7 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
         is_minus = true;
         text = text.substr(1);
     }
-    if (text.empty() || text[0] == '-' || !IsValidWord(text)) {
+    if (text.empty() || text[0] == '-' || (!chars_checked && !IsValidWord(text))) {
         std::string string_word(text);
         throw std::invalid_argument("Query word {\"" + string_word + "\"} is invalid");
     }
@@ -280,72 +985,197 @@ SearchServer::VecQueryNoSD SearchServer::ParseVecQueryNOSD(std::string_view text
 
 // Векторная версия Query с сортировкой и удалением дубликатов на string_view
 // Данная версия применяется для работы остальных функций
-SearchServer::VecQueryWSD::VecQueryWSD(std::vector<std::string_view> plus_words, std::vector<std::string_view> minus_words)
-    : plus_words(plus_words), minus_words(minus_words) {
+SearchServer::VecQueryWSD::VecQueryWSD(std::pmr::memory_resource* resource)
+    : plus_words(resource), minus_words(resource), phrases(resource), group_document_count(resource)
+    , plus_word_idf(resource) {
+}
+
+SearchServer::QueryPhrase::QueryPhrase(std::pmr::memory_resource* resource)
+    : terms(resource) {
 }
 // Векторная версия Query с сортировкой и удалением дубликатов на string_view
 // Данная версия применяется для работы остальных функций
-SearchServer::VecQueryWSD SearchServer::ParseVecQueryWSD(std::string_view text) const {
+SearchServer::VecQueryWSD SearchServer::ParseVecQueryWSD(std::string_view text, std::pmr::memory_resource* resource) const {
+
+    // разбор и проверка символов за один проход
+    std::pmr::vector<std::string_view> words(resource);
+    const size_t invalid_pos = SplitIntoWordsValidated(text, words);
+    if (invalid_pos != std::string_view::npos) {
+        std::string_view word = GetWordAt(text, invalid_pos);
+        if (word[0] == '-') {
+            word.remove_prefix(1);
+        }
+        std::string string_word(word);
+        throw std::invalid_argument("Query word {\"" + string_word + "\"} is invalid");
+    }
 
-    std::vector<std::string_view> plus_words;
-    std::vector<std::string_view> minus_words;
+    // слова сразу складываются в результат, без промежуточных копий
+    VecQueryWSD result(resource);
 
-    for (std::string_view word : SplitIntoWords(text)) {
-        const SearchServer::QueryWord query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                minus_words.push_back(query_word.data);
+    // открытая фраза и позиция следующего слова в ней
+    std::optional<QueryPhrase> phrase;
+    uint32_t phrase_position = 0;
+
+    for (std::string_view word : words) {
+        bool phrase_word = phrase.has_value();
+        bool closes_phrase = false;
+
+        if (word[0] == '"') {
+            if (phrase) {
+                throw std::invalid_argument("Nested phrases are not allowed");
             }
-            else {
-                plus_words.push_back(query_word.data);
+            phrase.emplace(resource);
+            phrase_position = 0;
+            phrase_word = true;
+            word.remove_prefix(1);
+        }
+        if (const size_t quote = word.find('"'); quote != std::string_view::npos) {
+            if (!phrase) {
+                throw std::invalid_argument("Phrase is not opened");
             }
+            const std::string_view tail = word.substr(quote + 1);
+            if (!tail.empty()) {
+                // "..."~N - допустимое число лишних слов между словами фразы
+                const auto [end, error] = std::from_chars(tail.data() + 1, tail.data() + tail.size(), phrase->slop);
+                if (tail[0] != '~' || tail.size() == 1 || error != std::errc() || end != tail.data() + tail.size()) {
+                    throw std::invalid_argument("Invalid phrase proximity {\"" + std::string(tail) + "\"}");
+                }
+            }
+            word = word.substr(0, quote);
+            closes_phrase = true;
         }
-    }
 
-    VecQueryWSD result;
-    result.minus_words.resize(minus_words.size());
-    result.plus_words.resize(plus_words.size());
+        if (!word.empty() && word.back() == '*') {
+            // слово* - все слова словаря с этим началом
+            if (phrase_word) {
+                throw std::invalid_argument("Prefix words are not allowed in phrases");
+            }
+            word.remove_suffix(1);
+            const SearchServer::QueryWord query_word = ParseQueryWord(word, true);
+            if (query_word.data.find('*') != std::string_view::npos) {
+                throw std::invalid_argument("Query word {\"" + std::string(word) + "*\"} is invalid");
+            }
+            ExpandPrefix(query_word.data, query_word.is_minus, result);
+        }
+        else if (!word.empty()) {
+            const SearchServer::QueryWord query_word = ParseQueryWord(word, true);
+            if (phrase_word && query_word.is_minus) {
+                throw std::invalid_argument("Minus words are not allowed in phrases");
+            }
+            if (!query_word.is_stop) {
+                if (query_word.is_minus) {
+                    result.minus_words.push_back(query_word.data);
+                }
+                else if (fuzzy_index_ && !phrase_word && word_to_document_freqs_.count(query_word.data) == 0) {
+                    ExpandFuzzy(query_word.data, result);
+                }
+                else {
+                    result.plus_words.push_back(query_word.data);
+                    if (phrase_word) {
+                        phrase->terms.emplace_back(query_word.data, phrase_position);
+                    }
+                }
+            }
+            phrase_position += phrase_word ? 1 : 0;
+        }
+
+        if (closes_phrase) {
+            // из одних стоп-слов фраза ничего не ограничивает
+            if (!phrase->terms.empty()) {
+                result.phrases.push_back(std::move(*phrase));
+            }
+            phrase.reset();
+        }
+    }
+    if (phrase) {
+        throw std::invalid_argument("Phrase is not closed");
+    }
+    if (!result.phrases.empty() && !positional_index_) {
+        throw std::invalid_argument("Phrase queries require positional index");
+    }
 
-    auto copy_sort_deduplucator =
-        [](std::vector<std::string_view>& input_vector, std::vector<std::string_view>& output_vector) {
-        auto end_it = std::move(std::execution::par, input_vector.begin(), input_vector.end(), output_vector.begin());
-        std::sort(std::execution::par, output_vector.begin(), end_it);
-        end_it = unique(output_vector.begin(), end_it);
-        output_vector.erase(end_it, output_vector.end());
+    auto sort_deduplucator = [](std::pmr::vector<std::string_view>& words) {
+        std::sort(std::execution::par, words.begin(), words.end());
+        words.erase(unique(words.begin(), words.end()), words.end());
     };
 
-    copy_sort_deduplucator(plus_words, result.plus_words);
-    copy_sort_deduplucator(minus_words, result.minus_words);
+    sort_deduplucator(result.plus_words);
+    sort_deduplucator(result.minus_words);
 
     return result;
 }
 
-// Existence required
-double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
-    return std::log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+void SearchServer::ExpandPrefix(std::string_view prefix, bool is_minus, VecQueryWSD& query) const {
+    const size_t first_word = query.plus_words.size();
+
+    // словарь упорядочен, слова с общим началом идут подряд
+    size_t expanded = 0;
+    for (auto it = word_to_document_freqs_.lower_bound(prefix);
+        it != word_to_document_freqs_.end() && expanded < MAX_PREFIX_EXPANSION
+        && it->first.substr(0, prefix.size()) == prefix; ++it, ++expanded) {
+        if (is_minus) {
+            query.minus_words.push_back(it->first);
+            continue;
+        }
+        query.plus_words.push_back(it->first);
+    }
+    if (!is_minus) {
+        AddWordGroup(query, first_word);
+    }
+}
+
+void SearchServer::ExpandFuzzy(std::string_view word, VecQueryWSD& query) const {
+    const size_t first_word = query.plus_words.size();
+    for (std::string_view term : fuzzy_index_->FindTerms(word, MAX_FUZZY_EXPANSION)) {
+        query.plus_words.push_back(term);
+    }
+    AddWordGroup(query, first_word);
+}
+
+void SearchServer::AddWordGroup(VecQueryWSD& query, size_t first_word) const {
+    if (first_word == query.plus_words.size()) {
+        return;
+    }
+    std::pmr::vector<int> document_ids(query.plus_words.get_allocator().resource());
+    for (size_t i = first_word; i < query.plus_words.size(); ++i) {
+        for (const auto& [document_id, _] : word_to_document_freqs_.at(query.plus_words[i])) {
+            document_ids.push_back(document_id);
+        }
+    }
+
+    // общий IDF считается по числу документов, в которых есть хоть одно из подставленных слов
+    std::sort(document_ids.begin(), document_ids.end());
+    const size_t document_count = std::unique(document_ids.begin(), document_ids.end()) - document_ids.begin();
+    for (size_t i = first_word; i < query.plus_words.size(); ++i) {
+        query.group_document_count.emplace(query.plus_words[i], document_count);
+    }
 }
 
 // Версия для работы без предиката
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
     const SearchServer::VecQueryWSD& query) const {
 
     size_t const MIN_PER_THREAD = 25;
     size_t const MAX_THREADS = (query.plus_words.size() + MIN_PER_THREAD - 1) / MIN_PER_THREAD;
     size_t const HARDWARE_THREADS = std::thread::hardware_concurrency();
-    size_t const NUM_THREADS = std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS);
+    size_t const NUM_THREADS = std::max<size_t>(1, std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS));
     size_t const BLOCK_SIZE = query.plus_words.size() / NUM_THREADS;
 
     ConcurrentMap<int, double> document_to_relevance_(BLOCK_SIZE);
 
 
-    std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
-        [this, &document_to_relevance_](std::string_view word) {
-            if (word_to_document_freqs_.count(word) != 0) {
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                    document_to_relevance_[document_id].ref_to_value += term_freq * inverse_document_freq;
+    WithTermScorer([this, &query, &document_to_relevance_](const auto& scorer) {
+        std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
+            [this, &query, &scorer, &document_to_relevance_](std::string_view word) {
+                if (word_to_document_freqs_.count(word) != 0) {
+                    const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+                    size_t cursor = 0;
+                    for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+                        document_to_relevance_[document_id].ref_to_value
+                            += scorer(document_id, term_freq, inverse_document_freq, cursor);
+                    }
                 }
-            } 
+            });
         });
 
     std::for_each(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
@@ -359,39 +1189,587 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::paral
 
     
 
-    std::vector<Document> matched_documents;
+    std::pmr::vector<Document> matched_documents(query.plus_words.get_allocator().resource());
     for (const auto& [document_id, relevance] : document_to_relevance_.BuildOrdinaryMap()) {
         matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
     }
     return matched_documents;
 }
 // Версия для работы без предиката
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
     const SearchServer::VecQueryWSD& query) const {
-    std::map<int, double> document_to_relevance;
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    std::pmr::map<int, double> document_to_relevance(resource);
     
-    for (std::string_view word : query.plus_words) {
+    WithTermScorer([this, &query, &document_to_relevance](const auto& scorer) {
+        for (std::string_view word : query.plus_words) {
+            if (word_to_document_freqs_.count(word) == 0) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+            size_t cursor = 0;
+            for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+                document_to_relevance[document_id] += scorer(document_id, term_freq, inverse_document_freq, cursor);
+            }
+        }
+        });
+
+    for (std::string_view word : query.minus_words) {
         if (word_to_document_freqs_.count(word) == 0) {
             continue;
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            document_to_relevance[document_id] += term_freq * inverse_document_freq;
+        for (const auto& [document_id, _] : word_to_document_freqs_.at(word)) {
+            document_to_relevance.erase(document_id);
+        }
+    }
+    
+    std::pmr::vector<Document> matched_documents(resource);
+    for (const auto [document_id, relevance] : document_to_relevance) {
+        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
+    }
+    return matched_documents;
+}
+
+size_t SearchServer::EstimatePostings(const VecQueryWSD& query, std::optional<DocumentStatus> status) const {
+    return EstimateQueryCost(query, status).posting_count;
+}
+
+QueryCost SearchServer::EstimateQueryCost(const VecQueryWSD& query, std::optional<DocumentStatus> status) const {
+    QueryCost cost;
+    cost.term_count = query.plus_words.size();
+    for (std::string_view word : query.plus_words) {
+        size_t count = 0;
+        if (status) {
+            const auto it = word_to_status_postings_.find(word);
+            count = it != word_to_status_postings_.end() ? it->second[static_cast<size_t>(*status)].size() : 0;
         }
+        else {
+            const auto it = word_to_document_freqs_.find(word);
+            count = it != word_to_document_freqs_.end() ? it->second.size() : 0;
+        }
+        cost.posting_count += count;
+        cost.max_term_postings = std::max(cost.max_term_postings, count);
+    }
+    return cost;
+}
+
+bool SearchServer::MatchesQuery(int document_id, const VecQueryWSD& query) const {
+    const auto document_words = document_to_word_freqs_.find(document_id);
+    if (document_words == document_to_word_freqs_.end()) {
+        return false;
+    }
+    const auto& word_freqs = document_words->second;
+    const auto contains = [&word_freqs](std::string_view word) { return word_freqs.count(word) > 0; };
+    return std::any_of(query.plus_words.begin(), query.plus_words.end(), contains)
+        && std::none_of(query.minus_words.begin(), query.minus_words.end(), contains);
+}
+
+namespace {
+
+    // Позиции из positions, до которых фраза дотягивается с одной из позиций reachable предыдущего слова:
+    // позиция годится, если лежит в окне [r + gap, r + gap + slop] хоть одной r из reachable.
+    // Оба списка упорядочены, поэтому проход один, двумя указателями, без перебора вариантов
+    void ReachPhrasePositions(const std::pmr::vector<uint32_t>& reachable, const std::pmr::vector<uint32_t>& positions,
+        uint64_t gap, uint64_t slop, std::pmr::vector<uint32_t>& result) {
+        result.clear();
+        size_t previous = 0;
+        for (const uint32_t position : positions) {
+            // первая позиция предыдущего слова, окно которой не кончилось до position
+            while (previous < reachable.size() && reachable[previous] + gap + slop < position) {
+                ++previous;
+            }
+            if (previous == reachable.size()) {
+                break;
+            }
+            if (reachable[previous] + gap <= position) {
+                result.push_back(position);
+            }
+        }
+    }
+}
+
+bool SearchServer::MatchesPhrases(int document_id, const VecQueryWSD& query) const {
+    if (query.phrases.empty()) {
+        return true;
+    }
+    const auto document_positions = document_positions_.find(document_id);
+    if (document_positions == document_positions_.end()) {
+        return false;
+    }
+
+    std::pmr::vector<std::pmr::vector<uint32_t>> term_positions(query.plus_words.get_allocator().resource());
+    for (const QueryPhrase& phrase : query.phrases) {
+        term_positions.resize(phrase.terms.size());
+        for (size_t i = 0; i < phrase.terms.size(); ++i) {
+            document_positions->second.GetPositions(phrase.terms[i].first, term_positions[i]);
+            if (term_positions[i].empty()) {
+                return false;
+            }
+        }
+        // достижимые позиции каждого следующего слова фразы - за один проход по спискам
+        std::pmr::vector<uint32_t> reachable(term_positions[0], term_positions.get_allocator().resource());
+        std::pmr::vector<uint32_t> next_reachable(term_positions.get_allocator().resource());
+        for (size_t i = 1; i < phrase.terms.size() && !reachable.empty(); ++i) {
+            ReachPhrasePositions(reachable, term_positions[i], phrase.terms[i].second - phrase.terms[i - 1].second,
+                phrase.slop, next_reachable);
+            reachable.swap(next_reachable);
+        }
+        if (reachable.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SearchServer::FilterByPhrases(const VecQueryWSD& query, std::pmr::vector<Document>& documents) const {
+    if (query.phrases.empty()) {
+        return;
+    }
+    documents.erase(std::remove_if(documents.begin(), documents.end(),
+        [this, &query](const Document& document) { return !MatchesPhrases(document.id, query); }),
+        documents.end());
+}
+
+double SearchServer::ComputeRelevance(int document_id, const VecQueryWSD& query) const {
+    const auto& word_freqs = document_to_word_freqs_.at(document_id);
+    return WithTermScorer([this, document_id, &query, &word_freqs](const auto& scorer) {
+        double relevance = 0.0;
+        for (std::string_view word : query.plus_words) {
+            const auto it = word_freqs.find(word);
+            if (it != word_freqs.end()) {
+                size_t cursor = 0;
+                relevance += scorer(document_id, it->second, ComputeQueryWordIdf(scorer, query, word), cursor);
+            }
+        }
+        return relevance;
+        });
+}
+
+// Версия с фильтром по статусу
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
+    const SearchServer::VecQueryWSD& query, DocumentStatus status) const {
+
+    size_t const MIN_PER_THREAD = 25;
+    size_t const MAX_THREADS = (query.plus_words.size() + MIN_PER_THREAD - 1) / MIN_PER_THREAD;
+    size_t const HARDWARE_THREADS = std::thread::hardware_concurrency();
+    size_t const NUM_THREADS = std::max<size_t>(1, std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS));
+    size_t const BLOCK_SIZE = query.plus_words.size() / NUM_THREADS;
+
+    ConcurrentMap<int, double> document_to_relevance_(BLOCK_SIZE);
+    const size_t status_index = static_cast<size_t>(status);
+
+    WithTermScorer([this, &query, status_index, &document_to_relevance_](const auto& scorer) {
+        std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
+            [this, &query, status_index, &scorer, &document_to_relevance_](std::string_view word) {
+                const auto it = word_to_status_postings_.find(word);
+                if (it != word_to_status_postings_.end()) {
+                    const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+                    size_t cursor = 0;
+                    for (const auto& [document_id, term_freq] : it->second[status_index]) {
+                        document_to_relevance_[document_id].ref_to_value
+                            += scorer(document_id, term_freq, inverse_document_freq, cursor);
+                    }
+                }
+            });
+        });
+
+    std::for_each(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
+        [this, status_index, &document_to_relevance_](std::string_view word) {
+            const auto it = word_to_status_postings_.find(word);
+            if (it != word_to_status_postings_.end()) {
+                for (const auto& [document_id, _] : it->second[status_index]) {
+                    document_to_relevance_.EraseKey(document_id);
+                }
+            }
+        });
+
+    std::pmr::vector<Document> matched_documents(query.plus_words.get_allocator().resource());
+    for (const auto& [document_id, relevance] : document_to_relevance_.BuildOrdinaryMap()) {
+        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
     }
+    return matched_documents;
+}
+// Версия с фильтром по статусу
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
+    const SearchServer::VecQueryWSD& query, DocumentStatus status) const {
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    std::pmr::map<int, double> document_to_relevance(resource);
+    const size_t status_index = static_cast<size_t>(status);
+
+    WithTermScorer([this, &query, status_index, &document_to_relevance](const auto& scorer) {
+        for (std::string_view word : query.plus_words) {
+            const auto it = word_to_status_postings_.find(word);
+            if (it == word_to_status_postings_.end()) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+            size_t cursor = 0;
+            for (const auto& [document_id, term_freq] : it->second[status_index]) {
+                document_to_relevance[document_id] += scorer(document_id, term_freq, inverse_document_freq, cursor);
+            }
+        }
+        });
 
     for (std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+        const auto it = word_to_status_postings_.find(word);
+        if (it == word_to_status_postings_.end()) {
             continue;
         }
-        for (const auto& [document_id, _] : word_to_document_freqs_.at(word)) {
+        for (const auto& [document_id, _] : it->second[status_index]) {
             document_to_relevance.erase(document_id);
         }
     }
-    
-    std::vector<Document> matched_documents;
+
+    std::pmr::vector<Document> matched_documents(resource);
     for (const auto [document_id, relevance] : document_to_relevance) {
         matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
     }
     return matched_documents;
-}
\ No newline at end of file
+}
+
+// ===================== СНИМОК ИНДЕКСА =====================
+
+namespace {
+
+    template <typename Record>
+    void AppendRecords(std::string& section, const std::vector<Record>& records) {
+        section.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    }
+
+    template <typename Record>
+    std::vector<Record> ReadRecords(std::string_view section) {
+        if (section.size() % sizeof(Record) != 0) {
+            throw std::runtime_error("Index snapshot section has invalid size");
+        }
+        std::vector<Record> records(section.size() / sizeof(Record));
+        std::memcpy(records.data(), section.data(), section.size());
+        return records;
+    }
+
+    uint64_t AlignIndexOffset(uint64_t offset) {
+        return (offset + INDEX_ALIGNMENT - 1) / INDEX_ALIGNMENT * INDEX_ALIGNMENT;
+    }
+
+    void CheckSnapshot(bool condition) {
+        if (!condition) {
+            using namespace std::literals::string_literals;
+            throw std::runtime_error("Index snapshot is corrupted"s);
+        }
+    }
+
+    // присоединяет поток при выходе из области видимости, в том числе по исключению:
+    // уничтожение неприсоединённого std::thread завершает программу
+    class ThreadJoiner {
+    public:
+        explicit ThreadJoiner(std::thread& thread)
+            : thread_(thread) {
+        }
+
+        ~ThreadJoiner() {
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+    private:
+        std::thread& thread_;
+    };
+
+} // namespace
+
+void SearchServer::Save(const std::string& path) const {
+
+    // документы и их тексты
+    std::vector<IndexDocumentRecord> document_records;
+    document_records.reserve(documents_.size());
+    std::string texts;
+    uint64_t forward_offset = 0;
+    for (const auto& [document_id, document_data] : documents_) {
+        IndexDocumentRecord record{};
+        record.document_id = document_id;
+        record.rating = document_data.rating_;
+        record.status = static_cast<int32_t>(document_data.status_);
+        record.word_count = document_columns_.GetLengths()[document_columns_.FindSlot(document_id)];
+        record.text_offset = texts.size();
+        record.text_size = document_data.text_.size();
+        record.forward_offset = forward_offset;
+        record.forward_count = GetWordFrequencies(document_id).size();
+        forward_offset += record.forward_count;
+
+        texts += document_data.text_;
+        document_records.push_back(record);
+    }
+
+    auto text_offset_of = [this, &document_records](int document_id, std::string_view word) {
+        const auto record = std::lower_bound(document_records.begin(), document_records.end(), document_id,
+            [](const IndexDocumentRecord& lhs, int id) { return lhs.document_id < id; });
+        return record->text_offset + static_cast<uint64_t>(word.data() - documents_.at(document_id).text_.data());
+    };
+
+    // словарь и постинги, слово ссылается на своё вхождение в первый документ из постинга
+    std::vector<std::string_view> term_words;
+    std::vector<IndexTermRecord> term_records;
+    std::vector<IndexPostingRecord> posting_records;
+    for (const auto& [word, postings] : word_to_document_freqs_) {
+        if (postings.empty()) {
+            continue;
+        }
+        const int owner_id = postings.begin()->first;
+        const std::string_view owner_word = document_to_word_freqs_.at(owner_id).find(word)->first;
+
+        IndexTermRecord record{};
+        record.text_offset = text_offset_of(owner_id, owner_word);
+        record.length = static_cast<uint32_t>(word.size());
+        record.postings_offset = posting_records.size();
+        record.postings_count = postings.size();
+        for (const auto& [document_id, term_freq] : postings) {
+            posting_records.push_back({ document_id, 0, term_freq });
+        }
+        term_words.push_back(word);
+        term_records.push_back(record);
+    }
+
+    // прямой индекс
+    std::vector<IndexForwardRecord> forward_records;
+    forward_records.reserve(forward_offset);
+    for (const auto& [document_id, word_freqs] : document_to_word_freqs_) {
+        for (const auto& [word, term_freq] : word_freqs) {
+            const auto term = std::lower_bound(term_words.begin(), term_words.end(), word);
+            IndexForwardRecord record{};
+            record.text_offset = text_offset_of(document_id, word);
+            record.term_index = static_cast<uint32_t>(term - term_words.begin());
+            record.term_freq = term_freq;
+            forward_records.push_back(record);
+        }
+    }
+
+    // стоп-слова
+    std::string stop_words_section;
+    const uint64_t stop_words_count = stop_words_.size();
+    stop_words_section.append(reinterpret_cast<const char*>(&stop_words_count), sizeof(stop_words_count));
+    for (const std::string& stop_word : stop_words_) {
+        const uint32_t length = static_cast<uint32_t>(stop_word.size());
+        stop_words_section.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        stop_words_section += stop_word;
+    }
+
+    std::vector<std::pair<IndexSectionKind, std::string>> sections(6);
+    sections[0] = { IndexSectionKind::STOP_WORDS, std::move(stop_words_section) };
+    sections[1].first = IndexSectionKind::DOCUMENTS;
+    AppendRecords(sections[1].second, document_records);
+    sections[2] = { IndexSectionKind::TEXTS, std::move(texts) };
+    sections[3].first = IndexSectionKind::TERMS;
+    AppendRecords(sections[3].second, term_records);
+    sections[4].first = IndexSectionKind::POSTINGS;
+    AppendRecords(sections[4].second, posting_records);
+    sections[5].first = IndexSectionKind::FORWARD;
+    AppendRecords(sections[5].second, forward_records);
+
+    // таблица секций, контрольные суммы считаются параллельно
+    std::vector<IndexSectionEntry> entries(sections.size());
+    uint64_t offset = AlignIndexOffset(sizeof(IndexFileHeader) + sizeof(IndexSectionEntry) * entries.size());
+    for (size_t i = 0; i < sections.size(); ++i) {
+        entries[i].kind = sections[i].first;
+        entries[i].reserved = 0;
+        entries[i].offset = offset;
+        entries[i].size = sections[i].second.size();
+        offset = AlignIndexOffset(offset + entries[i].size);
+    }
+    std::transform(std::execution::par, sections.begin(), sections.end(), entries.begin(), entries.begin(),
+        [](const auto& section, IndexSectionEntry entry) {
+            entry.checksum = ComputeIndexChecksum(section.second);
+            return entry;
+        });
+
+    IndexFileHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = INDEX_VERSION;
+    header.section_count = static_cast<uint32_t>(entries.size());
+    header.file_size = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Can't open index snapshot file for writing: " + path);
+    }
+    const char padding[INDEX_ALIGNMENT] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), sizeof(IndexSectionEntry) * entries.size());
+    uint64_t written = sizeof(header) + sizeof(IndexSectionEntry) * entries.size();
+    for (size_t i = 0; i < sections.size(); ++i) {
+        out.write(padding, entries[i].offset - written);
+        out.write(sections[i].second.data(), sections[i].second.size());
+        written = entries[i].offset + entries[i].size;
+    }
+    out.write(padding, header.file_size - written);
+    if (!out) {
+        throw std::runtime_error("Failed to write index snapshot: " + path);
+    }
+}
+
+SearchServer SearchServer::Load(const std::string& path) {
+
+    // файл читается целиком одним блоком
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Can't open index snapshot file: " + path);
+    }
+    std::string buffer(static_cast<size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(buffer.data(), buffer.size());
+    if (!in) {
+        throw std::runtime_error("Failed to read index snapshot: " + path);
+    }
+
+    IndexFileHeader header{};
+    if (buffer.size() < sizeof(header)) {
+        throw std::runtime_error("Index snapshot is truncated");
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("File is not an index snapshot");
+    }
+    if (header.version != INDEX_VERSION) {
+        throw std::runtime_error("Unsupported index snapshot version " + std::to_string(header.version));
+    }
+    if (header.file_size != buffer.size()
+        || buffer.size() < sizeof(header) + sizeof(IndexSectionEntry) * header.section_count) {
+        throw std::runtime_error("Index snapshot is truncated");
+    }
+
+    const std::vector<IndexSectionEntry> entries = ReadRecords<IndexSectionEntry>(
+        std::string_view(buffer).substr(sizeof(header), sizeof(IndexSectionEntry) * header.section_count));
+    for (const IndexSectionEntry& entry : entries) {
+        if (entry.offset > buffer.size() || entry.size > buffer.size() - entry.offset) {
+            throw std::runtime_error("Index snapshot section is out of file bounds");
+        }
+    }
+
+    // проверка контрольных сумм всех секций параллельно
+    if (!std::all_of(std::execution::par, entries.begin(), entries.end(),
+        [&buffer](const IndexSectionEntry& entry) {
+            return ComputeIndexChecksum(std::string_view(buffer).substr(entry.offset, entry.size)) == entry.checksum;
+        })) {
+        throw std::runtime_error("Index snapshot checksum mismatch");
+    }
+
+    auto section = [&buffer, &entries](IndexSectionKind kind) {
+        for (const IndexSectionEntry& entry : entries) {
+            if (entry.kind == kind) {
+                return std::string_view(buffer).substr(entry.offset, entry.size);
+            }
+        }
+        throw std::runtime_error("Index snapshot section is missing");
+    };
+
+    // стоп-слова
+    std::vector<std::string> stop_words;
+    {
+        std::string_view data = section(IndexSectionKind::STOP_WORDS);
+        uint64_t count = 0;
+        CheckSnapshot(data.size() >= sizeof(count));
+        std::memcpy(&count, data.data(), sizeof(count));
+        data.remove_prefix(sizeof(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            uint32_t length = 0;
+            CheckSnapshot(data.size() >= sizeof(length));
+            std::memcpy(&length, data.data(), sizeof(length));
+            data.remove_prefix(sizeof(length));
+            CheckSnapshot(length <= data.size());
+            stop_words.emplace_back(data.substr(0, length));
+            data.remove_prefix(length);
+        }
+    }
+    SearchServer server(stop_words);
+
+    const auto document_records = ReadRecords<IndexDocumentRecord>(section(IndexSectionKind::DOCUMENTS));
+    const std::string_view texts = section(IndexSectionKind::TEXTS);
+    const auto term_records = ReadRecords<IndexTermRecord>(section(IndexSectionKind::TERMS));
+    const auto posting_records = ReadRecords<IndexPostingRecord>(section(IndexSectionKind::POSTINGS));
+    const auto forward_records = ReadRecords<IndexForwardRecord>(section(IndexSectionKind::FORWARD));
+
+    // Контрольная сумма ловит случайную порчу, но не согласованность записей: каждое поле,
+    // которое дальше служит индексом или смещением, проверяется до сборки индекса.
+    // Документы идут по возрастанию id, тексты - подряд в том же порядке
+    for (size_t i = 0; i < document_records.size(); ++i) {
+        const IndexDocumentRecord& record = document_records[i];
+        CheckSnapshot(record.document_id >= 0
+            && (i == 0 || record.document_id > document_records[i - 1].document_id));
+        CheckSnapshot(record.status >= 0 && static_cast<size_t>(record.status) < STATUS_COUNT);
+        CheckSnapshot(IsIndexRangeInside(record.text_offset, record.text_size, texts.size()));
+        CheckSnapshot(i == 0 || record.text_offset >= document_records[i - 1].text_offset + document_records[i - 1].text_size);
+        CheckSnapshot(IsIndexRangeInside(record.forward_offset, record.forward_count, forward_records.size()));
+        for (uint64_t j = record.forward_offset; j < record.forward_offset + record.forward_count; ++j) {
+            const IndexForwardRecord& forward = forward_records[j];
+            CheckSnapshot(forward.term_index < term_records.size());
+            CheckSnapshot(forward.text_offset >= record.text_offset
+                && IsIndexRangeInside(forward.text_offset - record.text_offset, term_records[forward.term_index].length, record.text_size));
+        }
+    }
+    for (const IndexTermRecord& term : term_records) {
+        const auto owner = std::upper_bound(document_records.begin(), document_records.end(), term.text_offset,
+            [](uint64_t offset, const IndexDocumentRecord& record) { return offset < record.text_offset; });
+        CheckSnapshot(owner != document_records.begin());
+        CheckSnapshot(IsIndexRangeInside(term.text_offset - (owner - 1)->text_offset, term.length, (owner - 1)->text_size));
+        CheckSnapshot(IsIndexRangeInside(term.postings_offset, term.postings_count, posting_records.size()));
+    }
+    for (const IndexPostingRecord& posting : posting_records) {
+        const auto document = std::lower_bound(document_records.begin(), document_records.end(), posting.document_id,
+            [](const IndexDocumentRecord& record, int32_t document_id) { return record.document_id < document_id; });
+        CheckSnapshot(document != document_records.end() && document->document_id == posting.document_id);
+    }
+
+    // документы, записи отсортированы по id - вставка с подсказкой в конец
+    std::vector<const char*> document_texts;
+    document_texts.reserve(document_records.size());
+    for (const IndexDocumentRecord& record : document_records) {
+        const auto it = server.documents_.emplace_hint(server.documents_.end(), record.document_id,
+            DocumentData{ record.rating, static_cast<DocumentStatus>(record.status),
+                server.texts_.Store(texts.substr(record.text_offset, record.text_size)) });
+        server.document_ids_.emplace_hint(server.document_ids_.end(), record.document_id);
+        server.document_columns_.Insert(record.document_id, static_cast<DocumentStatus>(record.status), record.rating,
+            record.word_count);
+        document_texts.push_back(it->second.text_.data());
+    }
+
+    // прямой и обратный индексы независимы и собираются параллельно
+    std::thread forward_builder([&server, &document_records, &document_texts, &term_records, &forward_records] {
+        for (size_t i = 0; i < document_records.size(); ++i) {
+            const IndexDocumentRecord& record = document_records[i];
+            if (record.forward_count == 0) {
+                continue;
+            }
+            auto& word_freqs = server.document_to_word_freqs_.emplace_hint(
+                server.document_to_word_freqs_.end(), record.document_id, std::map<std::string_view, double>{})->second;
+            for (uint64_t j = record.forward_offset; j < record.forward_offset + record.forward_count; ++j) {
+                const IndexForwardRecord& forward = forward_records[j];
+                const std::string_view word(document_texts[i] + (forward.text_offset - record.text_offset),
+                    term_records[forward.term_index].length);
+                word_freqs.emplace_hint(word_freqs.end(), word, forward.term_freq);
+            }
+        }
+        });
+    const ThreadJoiner forward_builder_joiner(forward_builder);
+
+    for (const IndexTermRecord& term : term_records) {
+        // документ, в тексте которого лежит слово
+        const auto owner = std::upper_bound(document_records.begin(), document_records.end(), term.text_offset,
+            [](uint64_t offset, const IndexDocumentRecord& record) { return offset < record.text_offset; }) - 1;
+        const std::string_view word(document_texts[owner - document_records.begin()] + (term.text_offset - owner->text_offset),
+            term.length);
+
+        auto& postings = server.word_to_document_freqs_.emplace_hint(
+            server.word_to_document_freqs_.end(), word, std::map<int, double>{})->second;
+        auto& status_postings = server.word_to_status_postings_.emplace_hint(
+            server.word_to_status_postings_.end(), word, StatusPostings{})->second;
+        for (uint64_t j = term.postings_offset; j < term.postings_offset + term.postings_count; ++j) {
+            const IndexPostingRecord& posting = posting_records[j];
+            postings.emplace_hint(postings.end(), posting.document_id, posting.term_freq);
+            const DocumentStatus status = server.documents_.at(posting.document_id).status_;
+            status_postings[static_cast<size_t>(status)].emplace_back(posting.document_id, posting.term_freq);
+        }
+    }
+
+    forward_builder.join();
+    server.generation_ = NextGeneration();
+    return server;
+}
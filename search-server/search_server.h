@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <map>
+#include <numeric>
+#include <memory_resource>
 #include <algorithm>
 #include <cmath>
 #include <vector>
@@ -9,23 +12,106 @@
 #include <utility>
 #include <string_view>
 #include <thread>
+#include <optional>
+#include <type_traits>
+#include <variant>
 
 #include "read_input_functions.h"
 #include "document.h"
+#include "document_filters.h"
+#include "document_positions.h"
+#include "fuzzy_index.h"
+#include "document_fingerprint.h"
+#include "impact_index.h"
+#include "auto_execution.h"
+#include "scoring.h"
 #include "concurrent_map.h"
 #include "log_duration.h"
+#include "text_arena.h"
+#include "query_memory.h"
+#include "stop_words_filter.h"
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 const double RELEVANCE_THRESHOLD = 1e-6;
+//          *  
+const size_t MAX_PREFIX_EXPANSION = 64;
+//         
+const size_t MAX_FUZZY_EXPANSION = 16;
+//     -      
+const size_t MAX_EARLY_TERMINATION_WORDS = 2;
+
+//  :   ,   (  RELEVANCE_THRESHOLD) -   ,
+//    -   id.     :
+//         -         
+inline bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < RELEVANCE_THRESHOLD) {
+        if (lhs.rating != rhs.rating) {
+            return lhs.rating > rhs.rating;
+        }
+        return lhs.id < rhs.id;
+    }
+    else {
+        return lhs.relevance > rhs.relevance;
+    }
+}
 
-enum class DocumentStatus {
-    ACTUAL,
-    IRRELEVANT,
-    BANNED,
-    REMOVED,
+//      offset  offset + count   ,
+//     .      .
+//       offset  (nth_element),
+//      (partial_sort)
+template <typename Execution, typename RandomIt>
+RandomIt SelectDocumentsRange(const Execution& policy, RandomIt first, RandomIt last, size_t offset, size_t count) {
+    const size_t total = static_cast<size_t>(last - first);
+    if (offset >= total) {
+        return last;
+    }
+    const RandomIt page_begin = first + offset;
+    const RandomIt page_end = count < total - offset ? page_begin + count : last;
+    if (offset > 0) {
+        std::nth_element(policy, first, page_begin, last, IsMoreRelevant);
+    }
+    std::partial_sort(policy, page_begin, page_end, last, IsMoreRelevant);
+    return page_end;
+}
+
+//        ,    
+template <typename RandomIt>
+RandomIt SelectDocumentsRange(const AutoExecution& policy, RandomIt first, RandomIt last, size_t offset, size_t count) {
+    const size_t total = static_cast<size_t>(last - first);
+    if (ChooseExecution({ 1, total, total }, policy).mode == ExecutionMode::SEQUENTIAL) {
+        return SelectDocumentsRange(std::execution::seq, first, last, offset, count);
+    }
+    return SelectDocumentsRange(std::execution::par, first, last, offset, count);
+}
+
+//        
+struct DocumentsPage {
+    std::vector<Document> documents;
+    size_t total_count = 0;
 };
 
 
+//  ,   ,    -  ,   MatchDocument
+struct DocumentMatch {
+    int document_id = 0;
+    std::vector<std::string_view> words;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+};
+
+//   AddDocument    -      ,    
+enum class DuplicatePolicy {
+    ALLOW,      //  ,    
+    RECORD,     //  ,  (id, id )    
+    SKIP,       //   , AddDocument  id 
+    REJECT,     //   ,  std::invalid_argument
+};
+
+// ,   :  -    id   
+struct DuplicateRecord {
+    int document_id = 0;
+    int original_id = 0;
+};
+
 //    
 //      -,    
 class SearchServer {
@@ -40,14 +126,23 @@ public:
 
     explicit SearchServer(const std::string& stop_words_text);
 
-    //     
-    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    //     .
+    //  document_id,   DuplicatePolicy::SKIP   - id 
+    int AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
 
     //    
     //     
+    //   document_filters.h   ,    documents_
     template <typename Execution, typename DocumentPredicate>
     std::vector<Document> FindTopDocuments(const Execution& policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
 
+    //   ,          MAX_RESULT_DOCUMENT_COUNT
+    template <typename Execution, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const Execution& policy, std::string_view raw_query, 
+        DocumentPredicate document_predicate, size_t& matched_count) const;
+
+    //       ,   ,
+    //     
     template <typename Execution>
     std::vector<Document> FindTopDocuments(const Execution& policy, std::string_view raw_query, DocumentStatus status) const;
 
@@ -63,6 +158,24 @@ public:
 
     std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
 
+    //  : page_size     offset    .
+    //    offset + page_size ,    .
+    //     DocumentStatus
+    template <typename Execution, typename DocumentPredicate>
+    DocumentsPage FindDocumentsPage(const Execution& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, size_t offset, size_t page_size) const;
+
+    DocumentsPage FindDocumentsPage(std::string_view raw_query, size_t offset, size_t page_size) const;
+
+    //         (   -   id).
+    //     ,       
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsByRating(std::string_view raw_query, DocumentPredicate document_predicate) const;
+
+    std::vector<Document> FindTopDocumentsByRating(std::string_view raw_query, DocumentStatus status) const;
+
+    std::vector<Document> FindTopDocumentsByRating(std::string_view raw_query) const;
+
     //     
     size_t GetDocumentCount() const {
         return documents_.size();
@@ -86,6 +199,10 @@ public:
     }
 
     void RemoveDocument(const std::execution::parallel_policy&, int document_id);
+
+    //   :        ,
+    //     .  - id ,     
+    void RemoveDocuments(std::vector<int> document_ids);
     
     
     std::tuple<std::vector<std::string_view>, DocumentStatus>
@@ -97,8 +214,156 @@ public:
     std::tuple<std::vector<std::string_view>, DocumentStatus>
         MatchDocument(const std::execution::parallel_policy&, std::string_view raw_query, int document_id) const;
 
+    //     -    ,      
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+        MatchDocument(const AutoExecution&, std::string_view raw_query, int document_id) const {
+        return MatchDocument(std::execution::seq, raw_query, document_id);
+    }
+
+    //          document_ids.    ,
+    //       ,        .
+    //  -   id    document_ids,    -   MatchDocument.
+    //       id.  id -  std::out_of_range
+    std::vector<DocumentMatch> MatchDocuments(std::string_view raw_query) const;
+
+    std::vector<DocumentMatch> MatchDocuments(std::string_view raw_query, const std::vector<int>& document_ids) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::sequenced_policy&, std::string_view raw_query) const {
+        return MatchDocuments(std::execution::seq, raw_query, std::vector<int>(begin(), end()));
+    }
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::parallel_policy&, std::string_view raw_query) const {
+        return MatchDocuments(std::execution::par, raw_query, std::vector<int>(begin(), end()));
+    }
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::sequenced_policy&, std::string_view raw_query,
+        const std::vector<int>& document_ids) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::parallel_policy&, std::string_view raw_query,
+        const std::vector<int>& document_ids) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const AutoExecution& policy, std::string_view raw_query) const {
+        return MatchDocuments(policy, raw_query, std::vector<int>(begin(), end()));
+    }
+
+    std::vector<DocumentMatch> MatchDocuments(const AutoExecution& policy, std::string_view raw_query,
+        const std::vector<int>& document_ids) const;
+
     int GetDocumentId(int index) const;
 
+    //   (. ):      
+    class PreparedQuery;
+
+    //     -   ,   FindTopDocuments
+    PreparedQuery Prepare(std::string_view raw_query) const;
+
+    //            -  
+    bool IsCurrent(const PreparedQuery& query) const;
+
+    //       
+    void Refresh(PreparedQuery& query) const;
+
+    //      ,      
+    uint64_t GetGeneration() const {
+        return generation_;
+    }
+
+    template <typename Execution, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const Execution& policy, const PreparedQuery& query,
+        DocumentPredicate document_predicate) const;
+
+    template <typename Execution>
+    std::vector<Document> FindTopDocuments(const Execution& policy, const PreparedQuery& query) const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query, DocumentPredicate document_predicate) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+        MatchDocument(const PreparedQuery& query, int document_id) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const PreparedQuery& query) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const PreparedQuery& query, const std::vector<int>& document_ids) const;
+
+    std::vector<DocumentMatch> MatchDocuments(const std::execution::parallel_policy&, const PreparedQuery& query,
+        const std::vector<int>& document_ids) const;
+
+    //     :
+    // " " -  , " "~N -       ,
+    //       N  .
+    //       .     
+    void SetPositionalIndex(bool enabled);
+
+    bool HasPositionalIndex() const {
+        return positional_index_;
+    }
+
+    // ,   
+    size_t GetPositionsByteSize() const;
+
+    //   : -,    ,   
+    //      max_distance (1  2), 0 - .
+    //              .
+    //     
+    void SetFuzzySearch(int max_distance);
+
+    int GetFuzzyDistance() const {
+        return fuzzy_index_ ? fuzzy_index_->GetMaxDistance() : 0;
+    }
+
+    //      (document_fingerprint.h):   
+    //   ,   ,    .
+    //              ,
+    // ALLOW - .      .     
+    void SetDuplicatePolicy(DuplicatePolicy policy);
+
+    DuplicatePolicy GetDuplicatePolicy() const {
+        return duplicate_policy_;
+    }
+
+    //  ,   DuplicatePolicy::RECORD;     
+    const std::vector<DuplicateRecord>& GetDuplicateRecords() const {
+        return duplicate_records_;
+    }
+
+    void ClearDuplicateRecords() {
+        duplicate_records_.clear();
+    }
+
+    //   (scoring.h): TfIdfScoring    Bm25Scoring{ k1, b }.
+    //    ,       
+    void SetScoring(ScoringModel scoring) {
+        scoring_ = scoring;
+        impact_index_.reset();
+        generation_ = NextGeneration();
+    }
+
+    const ScoringModel& GetScoring() const {
+        return scoring_;
+    }
+
+    //    (impact_index.h)  FindTopDocuments  :
+    //    ,   -    ,
+    //   ,   .       ,
+    //        -   BuildImpactIndex
+    //    .   ,      
+    void BuildImpactIndex();
+
+    bool HasImpactIndex() const {
+        return impact_index_.has_value();
+    }
+
+    size_t GetImpactIndexByteSize() const;
+
+    //      (. index_format.h)
+    void Save(const std::string& path) const;
+
+    //    :      ,
+    //     
+    static SearchServer Load(const std::string& path);
+
 
     // ===========     =============
     
@@ -126,32 +391,86 @@ public:
     const auto GetDocumentMassive() const {
         return document_to_word_freqs_;
     }
+    // Debug-    
+    const TextArena& GetTextStorage() const {
+        return texts_;
+    }
 
 private:
     //  DocumentData
     struct DocumentData {
         DocumentData() = default;
 
-        DocumentData(int rating_, DocumentStatus status_, std::string text_);
+        DocumentData(int rating_, DocumentStatus status_, std::string_view text_);
 
         int rating_ = 0;
         DocumentStatus status_ = DocumentStatus::ACTUAL;
-        std::string text_;
+        std::string_view text_;         //    texts_
     };
 
     const VirturlStringSet stop_words_;
+    //   -,   stop_words_
+    const StopWordsFilter stop_words_filter_;
+    //  ,     string_view  
+    TextArena texts_;
     //         
 
     std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
     std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
     std::map<int, DocumentData> documents_;
     std::set<int> document_ids_;
+
+    static constexpr size_t STATUS_COUNT = 4;
+    //   ,    :  (id, tf)   id
+    using StatusPostings = std::array<std::vector<std::pair<int, double>>, STATUS_COUNT>;
+    //        ,   ,   word_to_document_freqs_
+    std::map<std::string_view, StatusPostings> word_to_status_postings_;
+    //     ,    document_filters.h
+    DocumentColumns document_columns_;
+    //   ,      
+    bool positional_index_ = false;
+    std::map<int, DocumentPositions> document_positions_;
+    //      ,  -  
+    std::optional<FuzzyIndex> fuzzy_index_;
+    //     ,   DuplicatePolicy::ALLOW
+    DuplicatePolicy duplicate_policy_ = DuplicatePolicy::ALLOW;
+    std::optional<FingerprintIndex> fingerprint_index_;
+    std::vector<DuplicateRecord> duplicate_records_;
+    ScoringModel scoring_;
+    std::optional<ImpactIndex> impact_index_;
+    //    ,     .
+    //       (NextGeneration),  , 
+    //   ,   ,  
+    uint64_t generation_ = NextGeneration();
     std::map<std::string_view, double> dummy_;
 
+    //  ,      
+    static uint64_t NextGeneration();
+
     bool IsStopWord(std::string_view word) const;
 
+    //  id      , words -     
+    std::optional<int> FindOriginal(const DocumentFingerprint& fingerprint, const std::vector<std::string_view>& words) const;
+
+    //     ,     
+    void EraseFingerprint(int document_id);
+
+    //   ,  document_columns_, id  
+    void EraseDocument(int document_id);
+
+    //     :   ,
+    //  ,     ,    
+    void EraseFromWordIndex(int document_id, const std::map<std::string_view, double>& word_freqs);
+
+    void AddStatusPosting(std::string_view word, int document_id, DocumentStatus status, double term_freq);
+
+    //       ,     
+    void EraseStatusPosting(std::string_view word, int document_id, DocumentStatus status);
+
     static bool IsValidWord(std::string_view word);
 
+    void BuildDocumentPositions(int document_id, std::string_view text);
+
     std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text) const;
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
@@ -166,7 +485,8 @@ private:
         bool is_stop = false;
     };
 
-    QueryWord ParseQueryWord(std::string_view text) const;
+    // chars_checked -         
+    QueryWord ParseQueryWord(std::string_view text, bool chars_checked = false) const;
 
     // =================    =====================
     //   Query   std::set  string_view
@@ -200,37 +520,211 @@ private:
 
     //   Query       string_view
     //       
+    //      ,      (QueryMemory)
+    //   :       (-  ,   )
+    struct QueryPhrase {
+        explicit QueryPhrase(std::pmr::memory_resource* resource);
+
+        std::pmr::vector<std::pair<std::string_view, uint32_t>> terms;
+        uint32_t slop = 0;   //        
+    };
+
     struct VecQueryWSD {
         VecQueryWSD() = default;
 
-        VecQueryWSD(std::vector<std::string_view> plus_words, std::vector<std::string_view> minus_words);
-
-        std::vector<std::string_view> plus_words = {};
-        std::vector<std::string_view> minus_words = {};
+        explicit VecQueryWSD(std::pmr::memory_resource* resource);
+
+        std::pmr::vector<std::string_view> plus_words = {};
+        std::pmr::vector<std::string_view> minus_words = {};
+        //      plus_words,     
+        std::pmr::vector<QueryPhrase> phrases = {};
+        // ,    (*)    ,   plus_words,
+        //       : IDF      
+        std::pmr::map<std::string_view, size_t> group_document_count = {};
+        // IDF  plus_words    ,     
+        std::pmr::vector<double> plus_word_idf = {};
     };
     //   Query       string_view
     //       
-    VecQueryWSD ParseVecQueryWSD(std::string_view text) const;
+    VecQueryWSD ParseVecQueryWSD(std::string_view text,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    // IDF     ,     
+    template <typename Scorer>
+    double ComputeQueryWordIdf(const Scorer& scorer, const VecQueryWSD& query, std::string_view word) const {
+        if (!query.plus_word_idf.empty()) {
+            //  : IDF   , plus_words 
+            const auto it = std::lower_bound(query.plus_words.begin(), query.plus_words.end(), word);
+            if (it != query.plus_words.end() && *it == word) {
+                return query.plus_word_idf[it - query.plus_words.begin()];
+            }
+        }
+        if (!query.group_document_count.empty()) {
+            const auto it = query.group_document_count.find(word);
+            if (it != query.group_document_count.end()) {
+                return scorer.ComputeIdf(GetDocumentCount(), it->second);
+            }
+        }
+        return scorer.ComputeIdf(GetDocumentCount(), word_to_document_freqs_.at(word).size());
+    }
+
+    //  func(scorer)  TermScorer   :
+    //  func     ,   -    
+    template <typename Func>
+    decltype(auto) WithTermScorer(Func func) const {
+        return std::visit([this, &func](const auto& scoring) {
+            return func(TermScorer<std::decay_t<decltype(scoring)>>(scoring, document_columns_));
+            }, scoring_);
+    }
+
+    //      (  MAX_PREFIX_EXPANSION)
+    void ExpandPrefix(std::string_view prefix, bool is_minus, VecQueryWSD& query) const;
+
+    //        
+    void ExpandFuzzy(std::string_view word, VecQueryWSD& query) const;
 
-    double ComputeWordInverseDocumentFreq(std::string_view word) const;
+    //  plus_words   first_word     
+    void AddWordGroup(VecQueryWSD& query, size_t first_word) const;
 
+    //       ,   
     //     
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, const VecQueryWSD& query) const;
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, const VecQueryWSD& query) const;
     //     
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, const VecQueryWSD& query) const;
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, const VecQueryWSD& query) const;
 
+    //     ,      
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, 
+        const VecQueryWSD& query, DocumentStatus status) const;
+    //     ,      
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, 
+        const VecQueryWSD& query, DocumentStatus status) const;
+
+    template <typename DocumentPredicate>
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, 
+        const VecQueryWSD& query, DocumentPredicate document_predicate) const;
+
+    //    :    ,    ,
+    //      FilterCheck
+    template <typename Filter>
+    std::pmr::vector<Document> FindAllDocumentsByFilter(const std::execution::sequenced_policy&,
+        const VecQueryWSD& query, const Filter& filter) const;
+
+    template <typename Filter>
+    std::pmr::vector<Document> FindAllDocumentsByFilter(const std::execution::parallel_policy&,
+        const VecQueryWSD& query, const Filter& filter) const;
+
+    //     : func(document_id, term_freq)
+    template <typename Func>
+    void ForEachPosting(std::string_view word, std::optional<DocumentStatus> status, Func func) const;
+
+    //    ,     
+    size_t EstimatePostings(const VecQueryWSD& query, std::optional<DocumentStatus> status) const;
+
+    //       ,    
+    QueryCost EstimateQueryCost(const VecQueryWSD& query, std::optional<DocumentStatus> status) const;
+
+    //    id  [first_id, last_id]: func(document_id, term_freq)
+    template <typename Func>
+    void ForEachPostingInRange(std::string_view word, std::optional<DocumentStatus> status,
+        int first_id, int last_id, Func func) const;
+
+    //    :   ,   
+    //   FindAllDocumentsByRange.     DocumentStatus
     template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, 
+    std::pmr::vector<Document> FindAllDocuments(const AutoExecution& policy,
         const VecQueryWSD& query, DocumentPredicate document_predicate) const;
 
+    //    :    range_count ,
+    //          id      ,
+    //           .
+    // status -    , nullopt - 
+    template <typename DocumentPredicate>
+    std::pmr::vector<Document> FindAllDocumentsByRange(const VecQueryWSD& query, std::optional<DocumentStatus> status,
+        DocumentPredicate document_predicate, size_t range_count) const;
+
+    //   -     -
+    bool MatchesQuery(int document_id, const VecQueryWSD& query) const;
+
+    //     
+    bool MatchesPhrases(int document_id, const VecQueryWSD& query) const;
+
+    //   MatchDocuments:       max_ranges  id,
+    //    
+    std::vector<DocumentMatch> MatchQueryDocuments(const VecQueryWSD& query, const std::vector<int>& document_ids,
+        size_t max_ranges) const;
+
+    //     matches[begin, end), matches   id
+    void MatchDocumentRange(const VecQueryWSD& query, std::vector<DocumentMatch>& matches, size_t begin, size_t end) const;
+
+    //    ,    
+    void FilterByPhrases(const VecQueryWSD& query, std::pmr::vector<Document>& documents) const;
+
+    double ComputeRelevance(int document_id, const VecQueryWSD& query) const;
+
+    // matched_count -     , nullptr -  
+    template <typename Execution, typename DocumentPredicate>
+    std::vector<Document> SelectTopDocuments(const Execution& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, size_t* matched_count) const;
+
+    template <typename Execution, typename DocumentPredicate>
+    std::vector<Document> SelectTopDocuments(const Execution& policy, const VecQueryWSD& query,
+        DocumentPredicate document_predicate, size_t* matched_count) const;
+
+    //   MatchDocument   
+    std::tuple<std::vector<std::string_view>, DocumentStatus>
+        MatchQueryDocument(const VecQueryWSD& query, int document_id) const;
+
+    //      :  ,   ,
+    //     .        ,
+    //    ,     -   
+    const VecQueryWSD& GetPreparedQuery(const PreparedQuery& query, std::optional<VecQueryWSD>& local_query) const;
+
+    //  MAX_RESULT_DOCUMENT_COUNT   status   
+    std::vector<Document> FindTopDocumentsByImpact(const VecQueryWSD& query, DocumentStatus status,
+        size_t& matched_count) const;
+
+    //        :     ,
+    //           .
+    // matched_count         -
+    std::vector<Document> FindTopDocumentsByImpactOrder(const VecQueryWSD& query, DocumentStatus status,
+        size_t* matched_count) const;
+
     template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, 
+    std::pmr::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, 
         const VecQueryWSD& query, DocumentPredicate document_predicate) const;
 };
 
+// ,      ,  SearchServer::Prepare.
+//     ,    , IDF    
+//      .   ,    .
+//   (,      ) 
+//  ,   ,  SearchServer::Refresh.   
+//     
+class SearchServer::PreparedQuery {
+public:
+    PreparedQuery() = default;
+
+    const std::string& GetText() const {
+        return *text_;
+    }
+
+    uint64_t GetGeneration() const {
+        return generation_;
+    }
+
+private:
+    friend class SearchServer;
+
+    //      ,      
+    std::unique_ptr<const std::string> text_ = std::make_unique<const std::string>();
+    VecQueryWSD query_;
+    const SearchServer* server_ = nullptr;
+    uint64_t generation_ = 0;
+};
+
 template <typename StringContainer>
 SearchServer::SearchServer(const StringContainer& stop_words)
-    : stop_words_(MakeUniqueNonEmptyStrings(stop_words))
+    : stop_words_(MakeUniqueNonEmptyStrings(stop_words)), stop_words_filter_(stop_words_)
 {
     if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
         throw std::invalid_argument("Some of stop words are invalid");
@@ -240,25 +734,95 @@ SearchServer::SearchServer(const StringContainer& stop_words)
 template <typename Execution, typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, 
     std::string_view raw_query, DocumentPredicate document_predicate) const {
+    return SelectTopDocuments(policy, raw_query, document_predicate, nullptr);
+}
+
+template <typename Execution, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, 
+    std::string_view raw_query, DocumentPredicate document_predicate, size_t& matched_count) const {
+    return SelectTopDocuments(policy, raw_query, document_predicate, &matched_count);
+}
 
-    const VecQueryWSD query = ParseVecQueryWSD(raw_query);
+template <typename Execution, typename DocumentPredicate>
+std::vector<Document> SearchServer::SelectTopDocuments(const Execution& policy,
+    std::string_view raw_query, DocumentPredicate document_predicate, size_t* matched_count) const {
 
-    std::vector<Document> matched_documents = FindAllDocuments(policy, query, document_predicate);;
+    //          
+    QueryMemory::Scope query_scope;
+    const VecQueryWSD query = ParseVecQueryWSD(raw_query, QueryMemory::GetResource());
+    return SelectTopDocuments(policy, query, document_predicate, matched_count);
+}
 
-    std::sort(policy, matched_documents.begin(), matched_documents.end(), [](const Document& lhs, const Document& rhs) {
-        if (std::abs(lhs.relevance - rhs.relevance) < RELEVANCE_THRESHOLD) {
-            return lhs.rating > rhs.rating;
-        }
-        else {
-            return lhs.relevance > rhs.relevance;
+template <typename Execution, typename DocumentPredicate>
+std::vector<Document> SearchServer::SelectTopDocuments(const Execution& policy,
+    const VecQueryWSD& query, DocumentPredicate document_predicate, size_t* matched_count) const {
+
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatus>) {
+        if (impact_index_ && query.phrases.empty() && query.group_document_count.empty()) {
+            //        ,   ,
+            //            -
+            if (query.plus_words.size() <= MAX_EARLY_TERMINATION_WORDS
+                && (!matched_count || (query.plus_words.size() == 1 && query.minus_words.empty()))) {
+                return FindTopDocumentsByImpactOrder(query, document_predicate, matched_count);
+            }
+            size_t count = 0;
+            std::vector<Document> result = FindTopDocumentsByImpact(query, document_predicate, count);
+            if (matched_count) {
+                *matched_count = count;
+            }
+            return result;
         }
-        });
+    }
 
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    std::pmr::vector<Document> matched_documents = FindAllDocuments(policy, query, document_predicate);
+    FilterByPhrases(query, matched_documents);
+    if (matched_count) {
+        *matched_count = matched_documents.size();
     }
 
-    return matched_documents;
+    //    MAX_RESULT_DOCUMENT_COUNT,   
+    const auto top_end = SelectDocumentsRange(policy, matched_documents.begin(), matched_documents.end(),
+        0, MAX_RESULT_DOCUMENT_COUNT);
+
+    return { matched_documents.begin(), top_end };
+}
+
+template <typename Execution, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, const PreparedQuery& query,
+    DocumentPredicate document_predicate) const {
+    QueryMemory::Scope query_scope;
+    std::optional<VecQueryWSD> local_query;
+    return SelectTopDocuments(policy, GetPreparedQuery(query, local_query), document_predicate, nullptr);
+}
+
+template <typename Execution>
+std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, const PreparedQuery& query) const {
+    return FindTopDocuments(policy, query, DocumentStatus::ACTUAL);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& query, DocumentPredicate document_predicate) const {
+    return FindTopDocuments(std::execution::seq, query, document_predicate);
+}
+
+template <typename Execution, typename DocumentPredicate>
+DocumentsPage SearchServer::FindDocumentsPage(const Execution& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, size_t offset, size_t page_size) const {
+
+    QueryMemory::Scope query_scope;
+    const VecQueryWSD query = ParseVecQueryWSD(raw_query, QueryMemory::GetResource());
+
+    std::pmr::vector<Document> matched_documents = FindAllDocuments(policy, query, document_predicate);
+    FilterByPhrases(query, matched_documents);
+
+    DocumentsPage page;
+    page.total_count = matched_documents.size();
+    if (offset < matched_documents.size()) {
+        const auto page_end = SelectDocumentsRange(policy, matched_documents.begin(), matched_documents.end(),
+            offset, page_size);
+        page.documents.assign(matched_documents.begin() + offset, page_end);
+    }
+    return page;
 }
 
 template <typename DocumentPredicate>
@@ -269,9 +833,79 @@ std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
 template <typename Execution>
 std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, 
     std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-        });
+    return SelectTopDocuments(policy, raw_query, status, nullptr);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsByRating(std::string_view raw_query, DocumentPredicate document_predicate) const {
+    QueryMemory::Scope query_scope;
+    std::pmr::memory_resource* resource = QueryMemory::GetResource();
+    const VecQueryWSD query = ParseVecQueryWSD(raw_query, resource);
+
+    const size_t document_count = document_columns_.size();
+    std::vector<Document> result;
+
+    if (EstimatePostings(query, GetRequiredStatus(document_predicate)) * 4 >= document_count) {
+        //       -    
+        //  ,  MAX_RESULT_DOCUMENT_COUNT 
+        const auto& by_rating = document_columns_.GetByRating();
+        auto group_end = by_rating.end();
+        while (group_end != by_rating.begin() && result.size() < MAX_RESULT_DOCUMENT_COUNT) {
+            const int rating = std::prev(group_end)->rating;
+            const auto group_begin = document_columns_.FindRatingRange(rating, rating).first;
+            for (auto it = group_begin; it != group_end && result.size() < MAX_RESULT_DOCUMENT_COUNT; ++it) {
+                if (document_predicate(it->document_id, it->status, it->rating) && MatchesQuery(it->document_id, query)
+                    && MatchesPhrases(it->document_id, query)) {
+                    result.push_back({ it->document_id, 0.0, it->rating });
+                }
+            }
+            group_end = group_begin;
+        }
+    }
+    else {
+        //     -       
+        //          
+        const std::optional<DocumentStatus> status = GetRequiredStatus(document_predicate);
+        const auto collect_ids = [this, resource, status](const std::pmr::vector<std::string_view>& words) {
+            std::pmr::vector<int> ids(resource);
+            for (std::string_view word : words) {
+                ForEachPosting(word, status, [&ids](int document_id, double) {
+                    ids.push_back(document_id);
+                    });
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            return ids;
+        };
+        const std::pmr::vector<int> candidates = collect_ids(query.plus_words);
+        const std::pmr::vector<int> excluded = collect_ids(query.minus_words);
+
+        std::pmr::vector<Document> matched_documents(resource);
+        for (int document_id : candidates) {
+            if (std::binary_search(excluded.begin(), excluded.end(), document_id)) {
+                continue;
+            }
+            const size_t slot = document_columns_.FindSlot(document_id);
+            const int rating = document_columns_.GetRatings()[slot];
+            if (document_predicate(document_id, document_columns_.GetStatuses()[slot], rating)) {
+                matched_documents.push_back({ document_id, 0.0, rating });
+            }
+        }
+        FilterByPhrases(query, matched_documents);
+
+        const auto top_end = matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT
+            ? matched_documents.begin() + MAX_RESULT_DOCUMENT_COUNT : matched_documents.end();
+        std::partial_sort(matched_documents.begin(), top_end, matched_documents.end(),
+            [](const Document& lhs, const Document& rhs) {
+                return lhs.rating > rhs.rating || (lhs.rating == rhs.rating && lhs.id < rhs.id);
+            });
+        result.assign(matched_documents.begin(), top_end);
+    }
+
+    for (Document& document : result) {
+        document.relevance = ComputeRelevance(document.id, query);
+    }
+    return result;
 }
 
 template <typename Execution>
@@ -280,29 +914,40 @@ std::vector<Document> SearchServer::FindTopDocuments(const Execution& policy, st
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
     const SearchServer::VecQueryWSD& query, DocumentPredicate document_predicate) const {
 
+    if constexpr (std::is_same_v<DocumentPredicate, StatusIs>) {
+        return FindAllDocuments(std::execution::par, query, document_predicate.status);
+    }
+    else if constexpr (IsDocumentFilter<DocumentPredicate>) {
+        return FindAllDocumentsByFilter(std::execution::par, query, document_predicate);
+    }
+
     size_t const MIN_PER_THREAD = 25;
     size_t const MAX_THREADS = (query.plus_words.size() + MIN_PER_THREAD - 1) / MIN_PER_THREAD;
     size_t const HARDWARE_THREADS = std::thread::hardware_concurrency();
-    size_t const NUM_THREADS = std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS);
+    size_t const NUM_THREADS = std::max<size_t>(1, std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS));
     size_t const BLOCK_SIZE = query.plus_words.size() / NUM_THREADS;
 
     ConcurrentMap<int, double> document_to_relevance_(BLOCK_SIZE);
 
 
-    std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
-        [this, document_predicate, &document_to_relevance_](std::string_view word) {
-            if (word_to_document_freqs_.count(word) != 0) {
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                    const auto& document_data = documents_.at(document_id);
-                    if (document_predicate(document_id, document_data.status_, document_data.rating_)) {
-                        document_to_relevance_[document_id].ref_to_value += term_freq * inverse_document_freq;
+    WithTermScorer([this, &query, document_predicate, &document_to_relevance_](const auto& scorer) {
+        std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
+            [this, &query, document_predicate, &scorer, &document_to_relevance_](std::string_view word) {
+                if (word_to_document_freqs_.count(word) != 0) {
+                    const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+                    size_t cursor = 0;
+                    for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+                        const auto& document_data = documents_.at(document_id);
+                        if (document_predicate(document_id, document_data.status_, document_data.rating_)) {
+                            document_to_relevance_[document_id].ref_to_value
+                                += scorer(document_id, term_freq, inverse_document_freq, cursor);
+                        }
                     }
                 }
-            }
+            });
         });
 
     std::for_each(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
@@ -316,7 +961,7 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::paral
 
 
 
-    std::vector<Document> matched_documents;
+    std::pmr::vector<Document> matched_documents(query.plus_words.get_allocator().resource());
     for (const auto& [document_id, relevance] : document_to_relevance_.BuildOrdinaryMap()) {
         matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
     }
@@ -324,22 +969,34 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::paral
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
     const SearchServer::VecQueryWSD& query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
 
-    for (std::string_view word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status_, document_data.rating_)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+    if constexpr (std::is_same_v<DocumentPredicate, StatusIs>) {
+        return FindAllDocuments(std::execution::seq, query, document_predicate.status);
+    }
+    else if constexpr (IsDocumentFilter<DocumentPredicate>) {
+        return FindAllDocumentsByFilter(std::execution::seq, query, document_predicate);
+    }
+
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    std::pmr::map<int, double> document_to_relevance(resource);
+
+    WithTermScorer([this, &query, document_predicate, &document_to_relevance](const auto& scorer) {
+        for (std::string_view word : query.plus_words) {
+            if (word_to_document_freqs_.count(word) == 0) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+            size_t cursor = 0;
+            for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+                const auto& document_data = documents_.at(document_id);
+                if (document_predicate(document_id, document_data.status_, document_data.rating_)) {
+                    document_to_relevance[document_id] += scorer(document_id, term_freq, inverse_document_freq, cursor);
+                }
             }
         }
-    }
+        });
 
     for (std::string_view word : query.minus_words) {
         if (word_to_document_freqs_.count(word) == 0) {
@@ -350,7 +1007,233 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::seque
         }
     }
 
-    std::vector<Document> matched_documents;
+    std::pmr::vector<Document> matched_documents(resource);
+    for (const auto [document_id, relevance] : document_to_relevance) {
+        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
+    }
+    return matched_documents;
+}
+
+template <typename Func>
+void SearchServer::ForEachPosting(std::string_view word, std::optional<DocumentStatus> status, Func func) const {
+    if (status) {
+        const auto it = word_to_status_postings_.find(word);
+        if (it != word_to_status_postings_.end()) {
+            for (const auto& [document_id, term_freq] : it->second[static_cast<size_t>(*status)]) {
+                func(document_id, term_freq);
+            }
+        }
+    }
+    else {
+        const auto it = word_to_document_freqs_.find(word);
+        if (it != word_to_document_freqs_.end()) {
+            for (const auto& [document_id, term_freq] : it->second) {
+                func(document_id, term_freq);
+            }
+        }
+    }
+}
+
+template <typename Func>
+void SearchServer::ForEachPostingInRange(std::string_view word, std::optional<DocumentStatus> status,
+    int first_id, int last_id, Func func) const {
+    if (status) {
+        const auto it = word_to_status_postings_.find(word);
+        if (it == word_to_status_postings_.end()) {
+            return;
+        }
+        const auto& postings = it->second[static_cast<size_t>(*status)];
+        auto posting = std::lower_bound(postings.begin(), postings.end(), first_id,
+            [](const std::pair<int, double>& posting, int document_id) { return posting.first < document_id; });
+        for (; posting != postings.end() && posting->first <= last_id; ++posting) {
+            func(posting->first, posting->second);
+        }
+    }
+    else {
+        const auto it = word_to_document_freqs_.find(word);
+        if (it == word_to_document_freqs_.end()) {
+            return;
+        }
+        for (auto posting = it->second.lower_bound(first_id); posting != it->second.end() && posting->first <= last_id; ++posting) {
+            func(posting->first, posting->second);
+        }
+    }
+}
+
+template <typename DocumentPredicate>
+std::pmr::vector<Document> SearchServer::FindAllDocuments(const AutoExecution& policy,
+    const SearchServer::VecQueryWSD& query, DocumentPredicate document_predicate) const {
+
+    std::optional<DocumentStatus> status;
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatus>) {
+        status = document_predicate;
+    }
+    else {
+        status = GetRequiredStatus(document_predicate);
+    }
+
+    const ExecutionPlan plan = ChooseExecution(EstimateQueryCost(query, status), policy);
+    if (plan.mode == ExecutionMode::SEQUENTIAL) {
+        return FindAllDocuments(std::execution::seq, query, document_predicate);
+    }
+    if (plan.mode == ExecutionMode::TERM_PARALLEL) {
+        return FindAllDocuments(std::execution::par, query, document_predicate);
+    }
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatus>) {
+        //     
+        return FindAllDocumentsByRange(query, status, [](int, DocumentStatus, int) { return true; }, plan.thread_count);
+    }
+    else {
+        return FindAllDocumentsByRange(query, status, document_predicate, plan.thread_count);
+    }
+}
+
+template <typename DocumentPredicate>
+std::pmr::vector<Document> SearchServer::FindAllDocumentsByRange(const SearchServer::VecQueryWSD& query,
+    std::optional<DocumentStatus> status, DocumentPredicate document_predicate, size_t range_count) const {
+
+    const std::vector<int>& ids = document_columns_.GetIds();
+    const std::vector<DocumentStatus>& statuses = document_columns_.GetStatuses();
+    const std::vector<int>& ratings = document_columns_.GetRatings();
+    range_count = std::max<size_t>(1, std::min(range_count, ids.size()));
+
+    std::vector<std::vector<Document>> range_documents(range_count);
+    std::vector<size_t> ranges(range_count);
+    std::iota(ranges.begin(), ranges.end(), 0);
+
+    WithTermScorer([&](const auto& scorer) {
+        std::for_each(std::execution::par, ranges.begin(), ranges.end(), [&](size_t range) {
+            //  [first_slot, end_slot)  ,    id
+            const size_t first_slot = ids.size() * range / range_count;
+            const size_t end_slot = ids.size() * (range + 1) / range_count;
+            if (first_slot == end_slot) {
+                return;
+            }
+            const int first_id = ids[first_slot];
+            const int last_id = ids[end_slot - 1];
+
+            std::vector<double> relevance(end_slot - first_slot);
+            std::vector<bool> matched(end_slot - first_slot);
+            //      ,      -  
+            for (std::string_view word : query.plus_words) {
+                if (word_to_document_freqs_.count(word) == 0) {
+                    continue;
+                }
+                const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+                size_t slot = first_slot;
+                ForEachPostingInRange(word, status, first_id, last_id, [&](int document_id, double term_freq) {
+                    slot = document_columns_.FindSlotFrom(document_id, slot);
+                    size_t length_cursor = slot;
+                    relevance[slot - first_slot] += scorer(document_id, term_freq, inverse_document_freq, length_cursor);
+                    matched[slot - first_slot] = true;
+                    });
+            }
+            for (std::string_view word : query.minus_words) {
+                size_t slot = first_slot;
+                ForEachPostingInRange(word, status, first_id, last_id, [&](int document_id, double) {
+                    slot = document_columns_.FindSlotFrom(document_id, slot);
+                    matched[slot - first_slot] = false;
+                    });
+            }
+
+            std::vector<Document>& documents = range_documents[range];
+            for (size_t slot = first_slot; slot < end_slot; ++slot) {
+                if (matched[slot - first_slot] && document_predicate(ids[slot], statuses[slot], ratings[slot])) {
+                    documents.push_back({ ids[slot], relevance[slot - first_slot], ratings[slot] });
+                }
+            }
+            });
+        });
+
+    //     id,  -    ,    
+    std::pmr::vector<Document> matched_documents(query.plus_words.get_allocator().resource());
+    for (const std::vector<Document>& documents : range_documents) {
+        matched_documents.insert(matched_documents.end(), documents.begin(), documents.end());
+    }
+    return matched_documents;
+}
+
+template <typename Filter>
+std::pmr::vector<Document> SearchServer::FindAllDocumentsByFilter(const std::execution::parallel_policy&,
+    const SearchServer::VecQueryWSD& query, const Filter& filter) const {
+
+    size_t const MIN_PER_THREAD = 25;
+    size_t const MAX_THREADS = (query.plus_words.size() + MIN_PER_THREAD - 1) / MIN_PER_THREAD;
+    size_t const HARDWARE_THREADS = std::thread::hardware_concurrency();
+    size_t const NUM_THREADS = std::max<size_t>(1, std::min(HARDWARE_THREADS != 0 ? HARDWARE_THREADS : 2, MAX_THREADS));
+    size_t const BLOCK_SIZE = query.plus_words.size() / NUM_THREADS;
+
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    const std::optional<DocumentStatus> status = GetRequiredStatus(filter);
+    //    ,   
+    const FilterCheck<Filter> check(filter, document_columns_, EstimatePostings(query, status), resource);
+
+    ConcurrentMap<int, double> document_to_relevance_(BLOCK_SIZE);
+
+    WithTermScorer([this, &query, status, &check, &document_to_relevance_](const auto& scorer) {
+        std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
+            [this, &query, status, &check, &scorer, &document_to_relevance_](std::string_view word) {
+                if (word_to_document_freqs_.count(word) == 0) {
+                    return;
+                }
+                const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+                size_t cursor = 0;
+                size_t length_cursor = 0;
+                ForEachPosting(word, status, [&](int document_id, double term_freq) {
+                    if (check.Accepts(document_id, cursor)) {
+                        document_to_relevance_[document_id].ref_to_value
+                            += scorer(document_id, term_freq, inverse_document_freq, length_cursor);
+                    }
+                    });
+            });
+        });
+
+    std::for_each(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
+        [this, status, &document_to_relevance_](std::string_view word) {
+            ForEachPosting(word, status, [&document_to_relevance_](int document_id, double) {
+                document_to_relevance_.EraseKey(document_id);
+                });
+        });
+
+    std::pmr::vector<Document> matched_documents(resource);
+    for (const auto& [document_id, relevance] : document_to_relevance_.BuildOrdinaryMap()) {
+        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
+    }
+    return matched_documents;
+}
+
+template <typename Filter>
+std::pmr::vector<Document> SearchServer::FindAllDocumentsByFilter(const std::execution::sequenced_policy&,
+    const SearchServer::VecQueryWSD& query, const Filter& filter) const {
+    std::pmr::memory_resource* resource = query.plus_words.get_allocator().resource();
+    const std::optional<DocumentStatus> status = GetRequiredStatus(filter);
+    const FilterCheck<Filter> check(filter, document_columns_, EstimatePostings(query, status), resource);
+
+    std::pmr::map<int, double> document_to_relevance(resource);
+
+    WithTermScorer([this, &query, status, &check, &document_to_relevance](const auto& scorer) {
+        for (std::string_view word : query.plus_words) {
+            if (word_to_document_freqs_.count(word) == 0) {
+                continue;
+            }
+            const double inverse_document_freq = ComputeQueryWordIdf(scorer, query, word);
+            size_t cursor = 0;
+            size_t length_cursor = 0;
+            ForEachPosting(word, status, [&](int document_id, double term_freq) {
+                if (check.Accepts(document_id, cursor)) {
+                    document_to_relevance[document_id] += scorer(document_id, term_freq, inverse_document_freq, length_cursor);
+                }
+                });
+        }
+        });
+
+    for (std::string_view word : query.minus_words) {
+        ForEachPosting(word, status, [&document_to_relevance](int document_id, double) {
+            document_to_relevance.erase(document_id);
+            });
+    }
+
+    std::pmr::vector<Document> matched_documents(resource);
     for (const auto [document_id, relevance] : document_to_relevance) {
         matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating_ });
     }
@@ -0,0 +1,129 @@
+#include "stop_words_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+StopWordsFilter::StopWordsFilter(const VirturlStringSet& stop_words) {
+    if (stop_words.empty()) {
+        return;
+    }
+
+    std::vector<Slot> words;
+    words.reserve(stop_words.size());
+    for (const std::string& word : stop_words) {
+        words.push_back({ static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(word.size()) });
+        pool_ += word;
+        length_mask_ |= uint64_t(1) << LengthBit(word.size());
+        const unsigned char first = static_cast<unsigned char>(word[0]);
+        first_byte_mask_[first / 64] |= uint64_t(1) << (first % 64);
+    }
+
+    // неудача возможна только при очень неудачном распределении корзин, следующее зерно её исправляет
+    for (uint64_t seed = 0; !TryBuild(words, seed); ++seed) {
+    }
+}
+
+bool StopWordsFilter::TryBuild(const std::vector<Slot>& words, uint64_t seed) {
+    const size_t table_size = words.size();
+    const size_t bucket_count = (table_size + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    displacements_.assign(bucket_count, 0);
+
+    std::vector<uint64_t> hashes(words.size());
+    std::vector<uint32_t> word_buckets(words.size());
+    std::vector<uint32_t> bucket_sizes(bucket_count);
+    for (size_t i = 0; i < words.size(); ++i) {
+        hashes[i] = Hash({ pool_.data() + words[i].offset, words[i].length }, seed);
+        word_buckets[i] = static_cast<uint32_t>(GetBucket(hashes[i]));
+        ++bucket_sizes[word_buckets[i]];
+    }
+
+    // слова сгруппированы по корзинам, корзины - от больших к меньшим:
+    // большие размещаются, пока свободных ячеек много
+    std::vector<uint32_t> order(words.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+        const uint32_t lhs_bucket = word_buckets[lhs];
+        const uint32_t rhs_bucket = word_buckets[rhs];
+        if (bucket_sizes[lhs_bucket] != bucket_sizes[rhs_bucket]) {
+            return bucket_sizes[lhs_bucket] > bucket_sizes[rhs_bucket];
+        }
+        return lhs_bucket < rhs_bucket;
+        });
+
+    std::vector<Slot> table(table_size);
+    std::vector<bool> taken(table_size);
+    std::vector<size_t> positions;
+    for (size_t begin = 0; begin < order.size();) {
+        const uint32_t bucket = word_buckets[order[begin]];
+        const size_t end = begin + bucket_sizes[bucket];
+
+        // сдвиг подходит, если все слова корзины попали в разные свободные ячейки
+        uint32_t displacement = 0;
+        for (;; ++displacement) {
+            if (displacement == MAX_DISPLACEMENT) {
+                return false;
+            }
+            positions.clear();
+            bool fits = true;
+            for (size_t i = begin; i < end && fits; ++i) {
+                const size_t position = GetPosition(hashes[order[i]], displacement, table_size);
+                fits = !taken[position] && std::find(positions.begin(), positions.end(), position) == positions.end();
+                positions.push_back(position);
+            }
+            if (fits) {
+                break;
+            }
+        }
+
+        displacements_[bucket] = displacement;
+        for (size_t i = begin; i < end; ++i) {
+            taken[positions[i - begin]] = true;
+            table[positions[i - begin]] = words[order[i]];
+        }
+        begin = end;
+    }
+
+    seed_ = seed;
+    table_ = std::move(table);
+    return true;
+}
+
+bool StopWordsFilter::Contains(std::string_view word) const {
+    if (word.empty() || !(length_mask_ >> LengthBit(word.size()) & 1)) {
+        return false;
+    }
+    const unsigned char first = static_cast<unsigned char>(word[0]);
+    if (!(first_byte_mask_[first / 64] >> (first % 64) & 1)) {
+        return false;
+    }
+
+    const uint64_t hash = Hash(word, seed_);
+    const Slot& slot = table_[GetPosition(hash, displacements_[GetBucket(hash)], table_.size())];
+    return slot.length == word.size() && std::memcmp(pool_.data() + slot.offset, word.data(), word.size()) == 0;
+}
+
+uint64_t StopWordsFilter::Hash(std::string_view word, uint64_t seed) {
+    uint64_t hash = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (const char c : word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    // корзина берётся из старших битов, у FNV они плохо перемешаны для похожих коротких слов
+    return Mix(hash);
+}
+
+size_t StopWordsFilter::GetPosition(uint64_t hash, uint32_t displacement, size_t table_size) {
+    // соседние сдвиги дают независимые ячейки
+    return Reduce(static_cast<uint32_t>(Mix(hash ^ (displacement * 0x9E3779B97F4A7C15ull))), table_size);
+}
+
+uint64_t StopWordsFilter::Mix(uint64_t value) {
+    // финальное перемешивание splitmix64
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    return value;
+}
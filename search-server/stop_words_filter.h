@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string_processing.h"
+
+// Проверка принадлежности слова к стоп-словам через минимальную совершенную хеш-функцию.
+// Набор стоп-слов фиксирован при создании, поэтому строится схема "хеш и сдвиг" (hash and displace):
+// слова делятся по хешу на корзины примерно по BUCKET_SIZE слов, для каждой корзины подбирается
+// сдвиг, при котором её слова попадают в свободные ячейки. Ячеек ровно столько, сколько слов,
+// сдвиги занимают 4 байта на корзину. Проверка - один хеш, один сдвиг, одна ячейка и одно сравнение.
+// Перед хешированием отсекаются слова, длины или первого байта которых нет среди стоп-слов.
+class StopWordsFilter {
+public:
+    StopWordsFilter() = default;
+
+    explicit StopWordsFilter(const VirturlStringSet& stop_words);
+
+    bool Contains(std::string_view word) const;
+
+    // число ячеек таблицы, равно числу стоп-слов
+    size_t GetTableSize() const {
+        return table_.size();
+    }
+
+private:
+    struct Slot {
+        uint32_t offset = 0;   // начало слова в pool_
+        uint32_t length = 0;   // 0 - пустая ячейка
+    };
+
+    static const size_t BUCKET_SIZE = 4;
+    // столько сдвигов перебирается для корзины, прежде чем построение начнётся с другим зерном
+    static const uint32_t MAX_DISPLACEMENT = 1u << 24;
+
+    uint64_t length_mask_ = 0;                          // бит на длину, длины от 63 - в старший бит
+    std::array<uint64_t, 4> first_byte_mask_ = {};      // бит на значение первого байта
+    uint64_t seed_ = 0;
+    std::vector<uint32_t> displacements_;               // сдвиг каждой корзины
+    std::vector<Slot> table_;
+    std::string pool_;                                  // все стоп-слова подряд
+
+    static uint64_t Hash(std::string_view word, uint64_t seed);
+
+    // число из [0, range) по 32 битам value без деления
+    static size_t Reduce(uint32_t value, size_t range) {
+        return static_cast<size_t>((static_cast<uint64_t>(value) * range) >> 32);
+    }
+
+    size_t GetBucket(uint64_t hash) const {
+        return Reduce(static_cast<uint32_t>(hash >> 32), displacements_.size());
+    }
+
+    static size_t GetPosition(uint64_t hash, uint32_t displacement, size_t table_size);
+
+    static uint64_t Mix(uint64_t value);
+
+    // false, если для какой-то корзины не нашлось сдвига
+    bool TryBuild(const std::vector<Slot>& words, uint64_t seed);
+
+    static size_t LengthBit(size_t length) {
+        return length < 63 ? length : 63;
+    }
+};
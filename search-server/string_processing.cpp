@@ -1,5 +1,14 @@
 #include "string_processing.h"
 
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 std::vector<std::string> SplitIntoWords(const std::string& text) {
     std::vector<std::string> words;
     std::string word;
@@ -21,25 +30,133 @@ std::vector<std::string> SplitIntoWords(const std::string& text) {
     return words;
 }
 
-std::vector<std::string_view> SplitIntoWords(std::string_view str) {
-    std::vector<std::string_view> result;
+namespace {
 
-    str.remove_prefix(std::min(str.find_first_not_of(" "), str.size()));
-    const int64_t pos_end = str.npos;
-    while (str.size() != 0) {
+#if defined(__AVX2__)
+    const size_t BLOCK_SIZE = 32;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPLIT_WITH_SSE2
+    const size_t BLOCK_SIZE = 16;
+#else
+    const size_t BLOCK_SIZE = 32;
+#endif
 
-        int64_t next_space = str.find(' ');
-        if (next_space == pos_end) {
-            result.push_back(str.substr(0));
-            str.remove_prefix(str.size());
-        }
-        else {
-            result.push_back(str.substr(0, next_space));
-            str.remove_prefix(next_space);
+    int CountTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    bool IsControlChar(char c) {
+        return c >= '\0' && c < ' ';
+    }
+
+    // маски пробелов и управляющих символов для блока из count символов, по биту на символ
+    void ClassifyBlockScalar(const char* data, size_t count, uint32_t& space_mask, uint32_t& control_mask) {
+        space_mask = 0;
+        control_mask = 0;
+        for (size_t i = 0; i < count; ++i) {
+            space_mask |= static_cast<uint32_t>(data[i] == ' ') << i;
+            control_mask |= static_cast<uint32_t>(IsControlChar(data[i])) << i;
         }
+    }
 
-        str.remove_prefix(std::min(str.find_first_not_of(" "), str.size()));
+    // то же для полного блока из BLOCK_SIZE символов
+    void ClassifyBlock(const char* data, uint32_t& space_mask, uint32_t& control_mask) {
+#if defined(__AVX2__)
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        space_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '))));
+        // управляющие символы: 0 <= c < ' ' в знаковом сравнении
+        const __m256i not_negative = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(-1));
+        const __m256i below_space = _mm256_cmpgt_epi8(_mm256_set1_epi8(' '), chunk);
+        control_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(not_negative, below_space)));
+#elif defined(SPLIT_WITH_SSE2)
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        space_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '))));
+        // управляющие символы: 0 <= c < ' ' в знаковом сравнении
+        const __m128i not_negative = _mm_cmpgt_epi8(chunk, _mm_set1_epi8(-1));
+        const __m128i below_space = _mm_cmplt_epi8(chunk, _mm_set1_epi8(' '));
+        control_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(not_negative, below_space)));
+#else
+        ClassifyBlockScalar(data, BLOCK_SIZE, space_mask, control_mask);
+#endif
     }
 
+    // Разбор идёт блоками: по маске пробелов находятся смены "пробел/слово",
+    // то есть начала и концы слов, а маска управляющих символов даёт позицию первого недопустимого символа
+    template <typename Container>
+    size_t SplitIntoWordsTo(std::string_view str, Container& result) {
+        size_t invalid_pos = std::string_view::npos;
+        size_t word_start = 0;
+        bool in_word = false;
+
+        auto process_block = [&](size_t block_pos, size_t count, uint32_t space_mask, uint32_t control_mask) {
+            if (control_mask != 0 && invalid_pos == std::string_view::npos) {
+                invalid_pos = block_pos + CountTrailingZeros(control_mask);
+            }
+            const uint32_t count_mask = count == 32 ? 0xFFFFFFFFu : ((1u << count) - 1);
+            const uint32_t word_mask = ~space_mask & count_mask;
+            // бит i установлен, если символ i отличается по типу от предыдущего
+            uint32_t changes = (word_mask ^ ((word_mask << 1) | static_cast<uint32_t>(in_word))) & count_mask;
+            while (changes != 0) {
+                const size_t pos = block_pos + CountTrailingZeros(changes);
+                if (in_word) {
+                    result.push_back(str.substr(word_start, pos - word_start));
+                }
+                else {
+                    word_start = pos;
+                }
+                in_word = !in_word;
+                changes &= changes - 1;
+            }
+        };
+
+        size_t pos = 0;
+        uint32_t space_mask = 0;
+        uint32_t control_mask = 0;
+        for (; pos + BLOCK_SIZE <= str.size(); pos += BLOCK_SIZE) {
+            ClassifyBlock(str.data() + pos, space_mask, control_mask);
+            process_block(pos, BLOCK_SIZE, space_mask, control_mask);
+        }
+        if (pos < str.size()) {
+            ClassifyBlockScalar(str.data() + pos, str.size() - pos, space_mask, control_mask);
+            process_block(pos, str.size() - pos, space_mask, control_mask);
+        }
+        if (in_word) {
+            result.push_back(str.substr(word_start));
+        }
+        return invalid_pos;
+    }
+
+} // namespace
+
+std::vector<std::string_view> SplitIntoWords(std::string_view str) {
+    std::vector<std::string_view> result;
+    SplitIntoWordsTo(str, result);
+    return result;
+}
+
+std::pmr::vector<std::string_view> SplitIntoWords(std::string_view str, std::pmr::memory_resource* resource) {
+    std::pmr::vector<std::string_view> result(resource);
+    SplitIntoWordsTo(str, result);
     return result;
-}
\ No newline at end of file
+}
+
+size_t SplitIntoWordsValidated(std::string_view str, std::vector<std::string_view>& words) {
+    return SplitIntoWordsTo(str, words);
+}
+
+size_t SplitIntoWordsValidated(std::string_view str, std::pmr::vector<std::string_view>& words) {
+    return SplitIntoWordsTo(str, words);
+}
+
+std::string_view GetWordAt(std::string_view str, size_t pos) {
+    const size_t begin = str.rfind(' ', pos);
+    const size_t end = str.find(' ', pos);
+    const size_t word_begin = begin == std::string_view::npos ? 0 : begin + 1;
+    return str.substr(word_begin, end == std::string_view::npos ? std::string_view::npos : end - word_begin);
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <set>
 #include <iostream>
+#include <memory_resource>
+#include <string_view>
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -11,6 +13,19 @@ std::vector<std::string> SplitIntoWords(const std::string& text);
 
 std::vector<std::string_view> SplitIntoWords(std::string_view str);
 
+// то же, но вектор размещается в переданном ресурсе памяти
+std::pmr::vector<std::string_view> SplitIntoWords(std::string_view str, std::pmr::memory_resource* resource);
+
+// Разбивает строку на слова и за тот же проход ищет управляющие символы (0..31).
+// Слова дописываются в words, возвращается позиция первого управляющего символа или npos.
+// Строка обрабатывается блоками по 16/32 байта на SSE2/AVX2, без них - посимвольно.
+size_t SplitIntoWordsValidated(std::string_view str, std::vector<std::string_view>& words);
+
+size_t SplitIntoWordsValidated(std::string_view str, std::pmr::vector<std::string_view>& words);
+
+// слово строки, в котором находится позиция pos
+std::string_view GetWordAt(std::string_view str, size_t pos);
+
 using VirturlStringSet = std::set<std::string, std::less<>>;
 
 template <typename StringContainer>
@@ -55,11 +55,8 @@ void FindTopDocuments(const SearchServer& search_server, std::string_view raw_qu
 void MatchDocuments(const SearchServer& search_server, const std::string& query) {
     try {
         std::cout << "Matching by request: " << query << std::endl;
-        const int document_count = search_server.GetDocumentCount();
-        for (int index = 0; index < document_count; ++index) {
-            const int document_id = search_server.GetDocumentId(index);
-            const auto [words, status] = search_server.MatchDocument(query, document_id);
-            PrintMatchDocumentResult(document_id, words, status);
+        for (const DocumentMatch& match : search_server.MatchDocuments(query)) {
+            PrintMatchDocumentResult(match.document_id, match.words, match.status);
         }
     }
     catch (const std::invalid_argument& e) {
@@ -0,0 +1,109 @@
+#include "text_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+TextArena::TextArena(size_t chunk_size)
+    : chunk_size_(chunk_size) {
+}
+
+TextArena::TextArena(const TextArena& other)
+    : chunk_size_(other.chunk_size_), chunks_(other.chunks_), current_(nullptr) {
+    // текущий чанк оригинала продолжает заполняться оригиналом, копия в него не пишет
+}
+
+TextArena& TextArena::operator=(const TextArena& other) {
+    if (this != &other) {
+        chunk_size_ = other.chunk_size_;
+        chunks_ = other.chunks_;
+        current_ = nullptr;
+    }
+    return *this;
+}
+
+std::string_view TextArena::Store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+
+    Chunk* chunk = nullptr;
+    if (current_ != nullptr) {
+        Chunk& current = chunks_.at(current_);
+        if (current.capacity - current.used >= text.size()) {
+            chunk = &current;
+        }
+    }
+    if (chunk == nullptr && text.size() > chunk_size_) {
+        // тексты крупнее чанка получают собственный чанк под размер
+        chunk = &AllocateChunk(text.size());
+    }
+    else if (chunk == nullptr) {
+        // старый текущий чанк больше не пополняется, пустой сразу отдаём
+        if (current_ != nullptr && chunks_.at(current_).live_count == 0) {
+            chunks_.erase(current_);
+        }
+        chunk = &AllocateChunk(chunk_size_);
+        current_ = chunk->memory.get();
+    }
+
+    char* place = chunk->memory.get() + chunk->used;
+    std::memcpy(place, text.data(), text.size());
+    chunk->used += text.size();
+    ++chunk->live_count;
+    chunk->live_bytes += text.size();
+    return { place, text.size() };
+}
+
+void TextArena::Release(std::string_view text) {
+    if (text.empty()) {
+        return;
+    }
+
+    auto it = chunks_.upper_bound(text.data());
+    if (it == chunks_.begin()) {
+        return;
+    }
+    --it;
+    Chunk& chunk = it->second;
+    if (text.data() + text.size() > it->first + chunk.capacity) {
+        return;
+    }
+
+    --chunk.live_count;
+    chunk.live_bytes -= text.size();
+    if (chunk.live_count != 0) {
+        return;
+    }
+
+    if (it->first != current_) {
+        chunks_.erase(it);
+    }
+    else if (chunk.memory.use_count() == 1) {
+        // текущий чанк опустел и ни с кем не разделён - заполняем его заново
+        chunk.used = 0;
+    }
+}
+
+size_t TextArena::GetReservedBytes() const {
+    size_t result = 0;
+    for (const auto& [_, chunk] : chunks_) {
+        result += chunk.capacity;
+    }
+    return result;
+}
+
+size_t TextArena::GetLiveBytes() const {
+    size_t result = 0;
+    for (const auto& [_, chunk] : chunks_) {
+        result += chunk.live_bytes;
+    }
+    return result;
+}
+
+TextArena::Chunk& TextArena::AllocateChunk(size_t capacity) {
+    Chunk chunk;
+    chunk.memory = std::shared_ptr<char[]>(new char[capacity]);
+    chunk.capacity = capacity;
+    const char* begin = chunk.memory.get();
+    return chunks_.emplace(begin, std::move(chunk)).first->second;
+}
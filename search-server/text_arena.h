@@ -0,0 +1,54 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string_view>
+
+// Хранилище текстов документов крупными блоками (чанками) только на добавление.
+// Адрес сохранённого текста не меняется до его освобождения, поэтому string_view
+// на него можно использовать как ключи индексов.
+// Память возвращается целым чанком, когда в нём не остаётся живых текстов.
+// Копия хранилища делит уже записанные чанки с оригиналом (только чтение),
+// а новые тексты пишет в собственные чанки.
+class TextArena {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    explicit TextArena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    TextArena(const TextArena& other);
+    TextArena& operator=(const TextArena& other);
+
+    TextArena(TextArena&& other) = default;
+    TextArena& operator=(TextArena&& other) = default;
+
+    // копирует текст в хранилище, возвращает вид на сохранённую копию
+    std::string_view Store(std::string_view text);
+
+    // отмечает текст, полученный из Store, как неиспользуемый
+    void Release(std::string_view text);
+
+    size_t GetChunkCount() const {
+        return chunks_.size();
+    }
+
+    // память, занятая чанками этого хранилища
+    size_t GetReservedBytes() const;
+
+    // суммарный размер живых текстов
+    size_t GetLiveBytes() const;
+
+private:
+    struct Chunk {
+        std::shared_ptr<char[]> memory;
+        size_t capacity = 0;
+        size_t used = 0;
+        size_t live_count = 0;
+        size_t live_bytes = 0;
+    };
+
+    size_t chunk_size_;
+    std::map<const char*, Chunk> chunks_;     // по адресу начала чанка
+    const char* current_ = nullptr;           // чанк, в который идёт запись
+
+    Chunk& AllocateChunk(size_t capacity);
+};